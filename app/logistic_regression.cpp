@@ -101,7 +101,11 @@ int main(int argc, char** argv) {
   engine.StartEverything();
 
   // 1.1 Create table
-  const auto kTableId = engine.CreateTable<double>(ModelType::BSP, StorageType::Map);  // table 0
+  // parameters start at 1 on the servers, so workers need no initial round of Adds
+  TableConfig config;
+  config.initializer.type = InitializerType::Constant;
+  config.initializer.value = 1;
+  const auto kTableId = engine.CreateTable<double>(ModelType::BSP, StorageType::Map, 0, config);  // table 0
   
   DLOG(INFO) << "create table";
 
@@ -144,15 +148,10 @@ int main(int argc, char** argv) {
 
     std::vector<Key> target_keys;// parameters for this worker to update
     for (int i = p_start; i < p_end; ++i) target_keys.push_back((Key)i);
-    std::vector<double> target_vals(target_keys.size(), 1);// parameters for this worker to update, initial values are all 1
+    std::vector<double> target_vals(target_keys.size());// parameters for this worker to update
 
     std::vector<int> data_index(batch_size);//  random picked record's index
 
-    all_parameters.clear();
-    table.Get(all_keys, &all_parameters);
-    table.Add(target_keys, target_vals);// initial parameters
-    table.Clock();
-
     for (int i = 0; i < round; ++i) {
         all_parameters.clear();
         table.Get(all_keys, &all_parameters);// get old parameters
@@ -6,4 +6,10 @@ namespace csci5570 {
 
 using Key = uint32_t;
 
+// How a table combines an Add with the stored value: overwrite it or sum into it
+enum class UpdateMode { Assign, Accumulate };
+
+// How a table keeps its values on the servers and on the wire: as the Val of the workers or with less precision
+enum class ValueEncoding { Native, Float32, Float16, BFloat16 };
+
 }  // namespace csci5570
@@ -11,14 +11,19 @@ namespace csci5570 {
 
 struct Control {};
 
-enum class Flag : char { kExit, kBarrier, kResetWorkerInModel, kClock, kAdd, kGet };
-static const char* FlagName[] = {"kExit", "kBarrier", "kResetWorkerInModel", "kClock", "kAdd", "kGet"};
+enum class Flag : char { kExit, kBarrier, kResetWorkerInModel, kClock, kAdd, kGet, kSubscribe, kPush };
+static const char* FlagName[] = {"kExit",  "kBarrier", "kResetWorkerInModel", "kClock",
+                                 "kAdd",   "kGet",     "kSubscribe",          "kPush"};
 
 struct Meta {
   int sender;
   int recver;
   int model_id;
-  Flag flag;  // {kExit, kBarrier, kResetWorkerInModel, kClock, kAdd, kGet}
+  Flag flag;  // {kExit, kBarrier, kResetWorkerInModel, kClock, kAdd, kGet, kSubscribe, kPush}
+  // the clock of the sending worker for kAdd and kGet, -1 if the servers track it
+  // for kPush and the replies of SSP to kGet, the last clock of the worker at which it may read the values
+  int clock = -1;
+  int request_id = -1;  // identifies a kGet among those in flight in a process, echoed by its reply, -1 if blocking
 
   std::string DebugString() const {
     std::stringstream ss;
@@ -27,6 +32,8 @@ struct Meta {
     ss << ", recver: " << recver;
     ss << ", model_id: " << model_id;
     ss << ", flag: " << FlagName[static_cast<int>(flag)];
+    if (clock >= 0) ss << ", clock: " << clock;
+    if (request_id >= 0) ss << ", request_id: " << request_id;
 
     ss << "}";
     return ss.str();
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <algorithm>
 #include <cinttypes>
+#include <map>
 #include <vector>
 
 #include "base/abstract_partition_manager.hpp"
@@ -18,6 +20,20 @@ class RangePartitionManager : public AbstractPartitionManager {
 
   void Slice(const Keys& keys, std::vector<std::pair<int, Keys>>* sliced) const override {
       std::map<int, Keys> resultMap;// server id, keys
+      if (std::is_sorted(keys.begin(), keys.end())) {
+          // the keys of a range are a contiguous run of sorted keys, found by binary search
+          for (int i = 0; i < ranges_.size(); ++i) {
+              auto first = std::lower_bound(keys.begin(), keys.end(), ranges_[i].begin(),
+                                            [](Key key, uint64_t bound) { return key < bound; });
+              auto last = std::lower_bound(first, keys.end(), ranges_[i].end(),
+                                           [](Key key, uint64_t bound) { return key < bound; });
+              if (first != last) resultMap[server_thread_ids_[i]].CopyFrom(first, last - first);
+          }
+          for (auto it = resultMap.begin(); it != resultMap.end(); it++) {
+              sliced->push_back(std::make_pair(it->first, it->second));
+          }
+          return;
+      }
       for (auto key : keys) {
           for (int i = 0; i < ranges_.size(); ++i) {
               if (ranges_[i].begin() <= key && key < ranges_[i].end()) {//  begin <= key < end
@@ -49,6 +65,15 @@ class RangePartitionManager : public AbstractPartitionManager {
       }
   }
 
+  // the key range owned by a server thread
+  const third_party::Range& GetRange(uint32_t server_thread_id) const {
+      for (int i = 0; i < server_thread_ids_.size(); ++i) {
+          if (server_thread_ids_[i] == server_thread_id) return ranges_[i];
+      }
+      LOG(FATAL) << "server thread " << server_thread_id << " does not own a range";
+      return ranges_[0];
+  }
+
  private:
   std::vector<third_party::Range> ranges_;
 };
@@ -30,6 +30,23 @@ TEST_F(TestRangePartitionManager, SliceKeys) {
   EXPECT_EQ(sliced[1].second[1], 9);
 }
 
+TEST_F(TestRangePartitionManager, SliceUnsortedKeys) {
+  RangePartitionManager pm({0, 1, 2}, {{2, 4}, {4, 7}, {7, 10}});
+  third_party::SArray<Key> keys({9, 2, 8, 3});
+  std::vector<std::pair<int, AbstractPartitionManager::Keys>> sliced;
+  pm.Slice(keys, &sliced);
+
+  ASSERT_EQ(sliced.size(), 2);
+  EXPECT_EQ(sliced[0].first, 0);
+  EXPECT_EQ(sliced[1].first, 2);
+  ASSERT_EQ(sliced[0].second.size(), 2);  // keys 2, 3 in their order
+  ASSERT_EQ(sliced[1].second.size(), 2);  // keys 9, 8 in their order
+  EXPECT_EQ(sliced[0].second[0], 2);
+  EXPECT_EQ(sliced[0].second[1], 3);
+  EXPECT_EQ(sliced[1].second[0], 9);
+  EXPECT_EQ(sliced[1].second[1], 8);
+}
+
 TEST_F(TestRangePartitionManager, SliceKVs) {
   RangePartitionManager pm({0, 1, 2}, {{0, 4}, {4, 8}, {8, 10}});
   third_party::SArray<Key> keys({2, 5, 9});
@@ -55,4 +72,12 @@ TEST_F(TestRangePartitionManager, SliceKVs) {
   EXPECT_DOUBLE_EQ(sliced[2].second.second[0], .9);
 }
 
+TEST_F(TestRangePartitionManager, GetRange) {
+  RangePartitionManager pm({0, 1, 2}, {{0, 4}, {4, 8}, {8, 10}});
+  EXPECT_EQ(pm.GetRange(0).begin(), 0);
+  EXPECT_EQ(pm.GetRange(0).end(), 4);
+  EXPECT_EQ(pm.GetRange(2).begin(), 8);
+  EXPECT_EQ(pm.GetRange(2).size(), 2);
+}
+
 }  // namespace csci5570
@@ -1,15 +1,19 @@
 #pragma once
 
+#include <chrono>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <vector>
 
 namespace csci5570 {
 
 template <typename T>
 class ThreadsafeQueue {
  public:
+  using TimePoint = std::chrono::steady_clock::time_point;
+
   ThreadsafeQueue() = default;
   ~ThreadsafeQueue() = default;
   ThreadsafeQueue(const ThreadsafeQueue&) = delete;
@@ -20,6 +24,7 @@ class ThreadsafeQueue {
   void Push(T elem) {
     mu_.lock();
     queue_.push(std::move(elem));
+    if (record_push_times_) push_times_.push(std::chrono::steady_clock::now());
     mu_.unlock();
     cond_.notify_all();
   }
@@ -29,6 +34,41 @@ class ThreadsafeQueue {
     cond_.wait(lk, [this] { return !queue_.empty(); });
     *elem = std::move(queue_.front());
     queue_.pop();
+    if (record_push_times_) push_times_.pop();
+  }
+
+  // wait until the queue is not empty, then take all of its elements at once, with their push times if recorded
+  void WaitAndPopAll(std::vector<T>* elems, std::vector<TimePoint>* push_times = nullptr) {
+    std::queue<T> popped;
+    std::queue<TimePoint> popped_times;
+    {
+      std::unique_lock<std::mutex> lk(mu_);
+      cond_.wait(lk, [this] { return !queue_.empty(); });
+      std::swap(popped, queue_);
+      std::swap(popped_times, push_times_);
+    }
+    MoveOut(&popped, elems);
+    if (push_times) MoveOut(&popped_times, push_times);
+  }
+
+  // take all the elements without waiting, with their push times if recorded, return false if there is none
+  bool TryPopAll(std::vector<T>* elems, std::vector<TimePoint>* push_times = nullptr) {
+    std::queue<T> popped;
+    std::queue<TimePoint> popped_times;
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      std::swap(popped, queue_);
+      std::swap(popped_times, push_times_);
+    }
+    MoveOut(&popped, elems);
+    if (push_times) MoveOut(&popped_times, push_times);
+    return !elems->empty();
+  }
+
+  // record when each element is pushed, for a consumer that measures how long the elements wait, before any Push
+  void RecordPushTimes() {
+    std::lock_guard<std::mutex> lk(mu_);
+    record_push_times_ = true;
   }
 
   int Size() {
@@ -37,8 +77,20 @@ class ThreadsafeQueue {
   }
 
  private:
+  template <typename E>
+  static void MoveOut(std::queue<E>* popped, std::vector<E>* elems) {
+    elems->clear();
+    elems->reserve(popped->size());
+    while (!popped->empty()) {
+      elems->push_back(std::move(popped->front()));
+      popped->pop();
+    }
+  }
+
   std::mutex mu_;
   std::queue<T> queue_;
+  bool record_push_times_ = false;
+  std::queue<TimePoint> push_times_;  // the push time of each element of queue_ if record_push_times_
   std::condition_variable cond_;
 };
 
@@ -0,0 +1,270 @@
+#pragma once
+
+#include "base/magic.hpp"
+#include "base/third_party/sarray.h"
+
+#include "glog/logging.h"
+
+#include <cstring>
+#include <type_traits>
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+namespace csci5570 {
+
+/**
+ * Reduced precision values
+ *
+ * A table with a ValueEncoding other than Native stores its values in one of these types on the servers
+ * and sends them in the same type, while workers keep using their own Val type. Conversion happens on
+ * the workers when encoding Adds and decoding Get replies.
+ */
+
+// IEEE 754 binary32 -> binary16, rounding to nearest even
+inline uint16_t FloatToHalfBits(float f) {
+  uint32_t x;
+  memcpy(&x, &f, sizeof(x));
+  uint32_t sign = (x >> 16) & 0x8000;
+  uint32_t abs = x & 0x7fffffff;
+  if (abs >= 0x7f800000) return sign | (abs > 0x7f800000 ? 0x7e00 : 0x7c00);  // nan, inf
+  if (abs >= 0x477ff000) return sign | 0x7c00;  // rounds above the largest half, 65504
+  uint32_t exp = abs >> 23;
+  if (exp < 113) {
+    // subnormal half, in units of 2^-24
+    if (exp < 102) return sign;
+    uint32_t mant = (abs & 0x7fffff) | 0x800000;
+    uint32_t shift = 126 - exp;
+    uint32_t h = mant >> shift;
+    uint32_t rem = mant & ((1u << shift) - 1);
+    uint32_t half = 1u << (shift - 1);
+    if (rem > half || (rem == half && (h & 1))) ++h;
+    return sign | h;
+  }
+  uint32_t h = (abs - 0x38000000) >> 13;
+  uint32_t rem = abs & 0x1fff;
+  if (rem > 0x1000 || (rem == 0x1000 && (h & 1))) ++h;
+  return sign | h;
+}
+
+// IEEE 754 binary16 -> binary32, exact
+inline float HalfBitsToFloat(uint16_t h) {
+  uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+  uint32_t exp = (h >> 10) & 0x1f;
+  uint32_t mant = h & 0x3ff;
+  uint32_t x;
+  if (exp == 0x1f) {
+    x = sign | 0x7f800000 | (mant << 13);
+  } else if (exp != 0) {
+    x = sign | ((exp + 112) << 23) | (mant << 13);
+  } else if (mant == 0) {
+    x = sign;
+  } else {
+    // normalize a subnormal
+    uint32_t e = 113;
+    while (!(mant & 0x400)) {
+      mant <<= 1;
+      --e;
+    }
+    x = sign | (e << 23) | ((mant & 0x3ff) << 13);
+  }
+  float f;
+  memcpy(&f, &x, sizeof(f));
+  return f;
+}
+
+// binary32 -> bfloat16, rounding to nearest even
+inline uint16_t FloatToBFloat16Bits(float f) {
+  uint32_t x;
+  memcpy(&x, &f, sizeof(x));
+  if ((x & 0x7fffffff) > 0x7f800000) return (x >> 16) | 0x40;  // keep nan quiet
+  return (x + 0x7fff + ((x >> 16) & 1)) >> 16;
+}
+
+inline float BFloat16BitsToFloat(uint16_t b) {
+  uint32_t x = static_cast<uint32_t>(b) << 16;
+  float f;
+  memcpy(&f, &x, sizeof(f));
+  return f;
+}
+
+struct Half {
+  uint16_t bits = 0;
+  Half() = default;
+  Half(float f) : bits(FloatToHalfBits(f)) {}
+  operator float() const { return HalfBitsToFloat(bits); }
+  Half& operator+=(Half other) { return *this = Half(static_cast<float>(*this) + static_cast<float>(other)); }
+  Half& operator-=(Half other) { return *this = Half(static_cast<float>(*this) - static_cast<float>(other)); }
+};
+
+struct BFloat16 {
+  uint16_t bits = 0;
+  BFloat16() = default;
+  BFloat16(float f) : bits(FloatToBFloat16Bits(f)) {}
+  operator float() const { return BFloat16BitsToFloat(bits); }
+  BFloat16& operator+=(BFloat16 other) {
+    return *this = BFloat16(static_cast<float>(*this) + static_cast<float>(other));
+  }
+  BFloat16& operator-=(BFloat16 other) {
+    return *this = BFloat16(static_cast<float>(*this) - static_cast<float>(other));
+  }
+};
+
+// the size of one value of a table on the wire and in the storage
+template <typename Val>
+inline size_t EncodedSize(ValueEncoding encoding) {
+  switch (encoding) {
+    case ValueEncoding::Float32:
+      return sizeof(float);
+    case ValueEncoding::Float16:
+      return sizeof(Half);
+    case ValueEncoding::BFloat16:
+      return sizeof(BFloat16);
+    default:
+      return sizeof(Val);
+  }
+}
+
+// ========== conversion loops ========== //
+
+// dst[i] = To(src[i]), for i in [0, n)
+template <typename To, typename From>
+inline void ConvertValues(const From* src, size_t n, To* dst) {
+  for (size_t i = 0; i < n; ++i) dst[i] = static_cast<To>(static_cast<float>(src[i]));
+}
+
+template <>
+inline void ConvertValues<float, double>(const double* src, size_t n, float* dst) {
+  for (size_t i = 0; i < n; ++i) dst[i] = static_cast<float>(src[i]);
+}
+
+template <>
+inline void ConvertValues<double, float>(const float* src, size_t n, double* dst) {
+  for (size_t i = 0; i < n; ++i) dst[i] = src[i];
+}
+
+// the bfloat16 rounding is plain integer arithmetic on the bits, which compilers vectorize
+template <>
+inline void ConvertValues<BFloat16, float>(const float* src, size_t n, BFloat16* dst) {
+  for (size_t i = 0; i < n; ++i) dst[i].bits = FloatToBFloat16Bits(src[i]);
+}
+
+template <>
+inline void ConvertValues<float, BFloat16>(const BFloat16* src, size_t n, float* dst) {
+  for (size_t i = 0; i < n; ++i) dst[i] = BFloat16BitsToFloat(src[i].bits);
+}
+
+#if defined(__F16C__)
+template <>
+inline void ConvertValues<Half, float>(const float* src, size_t n, Half* dst) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+  }
+  for (; i < n; ++i) dst[i] = Half(src[i]);
+}
+
+template <>
+inline void ConvertValues<float, Half>(const Half* src, size_t n, float* dst) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+  }
+  for (; i < n; ++i) dst[i] = src[i];
+}
+#endif
+
+// convert through a small float buffer, so that the float kernels above do the work
+template <typename To, typename From>
+inline void ConvertValuesViaFloat(const From* src, size_t n, To* dst) {
+  const size_t kBlock = 256;
+  float buffer[kBlock];
+  for (size_t i = 0; i < n; i += kBlock) {
+    size_t m = n - i < kBlock ? n - i : kBlock;
+    ConvertValues<float, From>(src + i, m, buffer);
+    ConvertValues<To, float>(buffer, m, dst + i);
+  }
+}
+
+template <typename Val, typename Encoded>
+inline void EncodeAs(const Val* src, size_t n, char* dst) {
+  auto* typed_dst = reinterpret_cast<Encoded*>(dst);
+  if (std::is_same<Val, float>::value || std::is_same<Encoded, float>::value) {
+    ConvertValues<Encoded, Val>(src, n, typed_dst);
+  } else {
+    ConvertValuesViaFloat<Encoded, Val>(src, n, typed_dst);
+  }
+}
+
+template <typename Val, typename Encoded>
+inline void DecodeAs(const char* src, size_t n, Val* dst) {
+  auto* typed_src = reinterpret_cast<const Encoded*>(src);
+  if (std::is_same<Val, float>::value || std::is_same<Encoded, float>::value) {
+    ConvertValues<Val, Encoded>(typed_src, n, dst);
+  } else {
+    ConvertValuesViaFloat<Val, Encoded>(typed_src, n, dst);
+  }
+}
+
+/**
+ * Encode the values of a worker into the encoding of a table
+ * Native values are shared rather than copied
+ */
+template <typename Val>
+inline third_party::SArray<char> EncodeValues(ValueEncoding encoding, const third_party::SArray<Val>& vals) {
+  if (encoding == ValueEncoding::Native) return third_party::SArray<char>(vals);
+  third_party::SArray<char> encoded(vals.size() * EncodedSize<Val>(encoding));
+  switch (encoding) {
+    case ValueEncoding::Float32:
+      EncodeAs<Val, float>(vals.data(), vals.size(), encoded.data());
+      break;
+    case ValueEncoding::Float16:
+      EncodeAs<Val, Half>(vals.data(), vals.size(), encoded.data());
+      break;
+    case ValueEncoding::BFloat16:
+      EncodeAs<Val, BFloat16>(vals.data(), vals.size(), encoded.data());
+      break;
+    default:
+      break;
+  }
+  return encoded;
+}
+
+/**
+ * Decode n values of a table into a buffer of a worker
+ */
+template <typename Val>
+inline void DecodeValuesInto(ValueEncoding encoding, const char* src, size_t n, Val* dst) {
+  switch (encoding) {
+    case ValueEncoding::Float32:
+      DecodeAs<Val, float>(src, n, dst);
+      break;
+    case ValueEncoding::Float16:
+      DecodeAs<Val, Half>(src, n, dst);
+      break;
+    case ValueEncoding::BFloat16:
+      DecodeAs<Val, BFloat16>(src, n, dst);
+      break;
+    default:
+      memcpy(dst, src, n * sizeof(Val));
+      break;
+  }
+}
+
+/**
+ * Decode the values of a table into the values of a worker
+ * Native values are shared rather than copied
+ */
+template <typename Val>
+inline third_party::SArray<Val> DecodeValues(ValueEncoding encoding, const third_party::SArray<char>& encoded) {
+  if (encoding == ValueEncoding::Native) return third_party::SArray<Val>(encoded);
+  size_t n = encoded.size() / EncodedSize<Val>(encoding);
+  third_party::SArray<Val> vals(n);
+  DecodeValuesInto(encoding, encoded.data(), n, vals.data());
+  return vals;
+}
+
+}  // namespace csci5570
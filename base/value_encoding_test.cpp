@@ -0,0 +1,89 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "base/value_encoding.hpp"
+
+#include <cmath>
+#include <limits>
+
+namespace csci5570 {
+namespace {
+
+class TestValueEncoding : public testing::Test {
+ public:
+  TestValueEncoding() {}
+  ~TestValueEncoding() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+TEST_F(TestValueEncoding, HalfExact) {
+  // every finite half converts to float and back unchanged
+  for (uint32_t bits = 0; bits < 0x10000; ++bits) {
+    if ((bits & 0x7c00) == 0x7c00) continue;
+    EXPECT_EQ(FloatToHalfBits(HalfBitsToFloat(bits)), bits);
+  }
+  EXPECT_FLOAT_EQ(HalfBitsToFloat(0x3c00), 1.0f);
+  EXPECT_FLOAT_EQ(HalfBitsToFloat(0x0001), std::ldexp(1.0f, -24));  // smallest subnormal
+  EXPECT_FLOAT_EQ(HalfBitsToFloat(0x7bff), 65504.0f);
+}
+
+TEST_F(TestValueEncoding, HalfRounding) {
+  EXPECT_EQ(FloatToHalfBits(1.0f + std::ldexp(1.0f, -11)), 0x3c00);      // tie, rounds to even
+  EXPECT_EQ(FloatToHalfBits(1.0f + 3 * std::ldexp(1.0f, -11)), 0x3c02);  // tie, rounds to even
+  EXPECT_EQ(FloatToHalfBits(65520.0f), 0x7c00);                          // overflows to inf
+  EXPECT_EQ(FloatToHalfBits(-std::numeric_limits<float>::infinity()), 0xfc00);
+  EXPECT_EQ(FloatToHalfBits(std::ldexp(1.0f, -25)), 0);  // tie between 0 and the smallest subnormal
+  EXPECT_EQ(FloatToHalfBits(std::ldexp(1.5f, -25)), 1);
+  EXPECT_TRUE(std::isnan(HalfBitsToFloat(FloatToHalfBits(std::nanf("")))));
+}
+
+TEST_F(TestValueEncoding, BFloat16Rounding) {
+  EXPECT_FLOAT_EQ(BFloat16BitsToFloat(FloatToBFloat16Bits(1.5f)), 1.5f);
+  EXPECT_EQ(FloatToBFloat16Bits(1.0f + std::ldexp(1.0f, -8)), 0x3f80);  // tie, rounds to even
+  EXPECT_EQ(FloatToBFloat16Bits(1.0f + 3 * std::ldexp(1.0f, -8)), 0x3f82);
+  EXPECT_TRUE(std::isnan(BFloat16BitsToFloat(FloatToBFloat16Bits(std::nanf("")))));
+}
+
+TEST_F(TestValueEncoding, EncodeDecode) {
+  third_party::SArray<double> vals;
+  for (int i = 0; i < 1000; ++i) vals.push_back((i % 256 - 128) * 0.5);  // exact in all encodings
+
+  for (auto encoding : {ValueEncoding::Native, ValueEncoding::Float32, ValueEncoding::Float16,
+                        ValueEncoding::BFloat16}) {
+    auto encoded = EncodeValues(encoding, vals);
+    EXPECT_EQ(encoded.size(), vals.size() * EncodedSize<double>(encoding));
+    auto decoded = DecodeValues<double>(encoding, encoded);
+    ASSERT_EQ(decoded.size(), vals.size());
+    for (int i = 0; i < vals.size(); ++i) EXPECT_EQ(decoded[i], vals[i]);
+  }
+}
+
+TEST_F(TestValueEncoding, KernelsMatchScalar) {
+  third_party::SArray<float> vals;
+  for (int i = 0; i < 1003; ++i) vals.push_back(i * 0.0137f - 7.0f);
+  auto halves = EncodeValues(ValueEncoding::Float16, vals);
+  auto bfloats = EncodeValues(ValueEncoding::BFloat16, vals);
+  auto half_bits = third_party::SArray<uint16_t>(halves);
+  auto bfloat_bits = third_party::SArray<uint16_t>(bfloats);
+  for (int i = 0; i < vals.size(); ++i) {
+    EXPECT_EQ(half_bits[i], FloatToHalfBits(vals[i]));
+    EXPECT_EQ(bfloat_bits[i], FloatToBFloat16Bits(vals[i]));
+  }
+  auto decoded = DecodeValues<float>(ValueEncoding::Float16, halves);
+  for (int i = 0; i < vals.size(); ++i) EXPECT_EQ(decoded[i], HalfBitsToFloat(half_bits[i]));
+}
+
+TEST_F(TestValueEncoding, Accumulate) {
+  Half h(1.5f);
+  h += Half(2.25f);
+  EXPECT_FLOAT_EQ(h, 3.75f);
+  BFloat16 b(1.5f);
+  b += BFloat16(2.25f);
+  EXPECT_FLOAT_EQ(b, 3.75f);
+}
+
+}  // namespace
+}  // namespace csci5570
@@ -237,6 +237,8 @@ int Mailbox::Recv(Message* msg) {
       msg->meta.recver = meta->recver;
       msg->meta.model_id = meta->model_id;
       msg->meta.flag = meta->flag;
+      msg->meta.clock = meta->clock;
+      msg->meta.request_id = meta->request_id;
       zmq_msg_close(zmsg);
       bool more = zmq_msg_more(zmsg);
       delete zmsg;
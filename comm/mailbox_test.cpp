@@ -73,6 +73,30 @@ TEST_F(TestMailbox, SendAndRecv) {
 
   mailbox.CloseSockets();
 }
+TEST_F(TestMailbox, SendAndRecvClockAndRequestId) {
+  Node node{0, "localhost", 32145};
+  FakeIdMapper id_mapper;
+  Mailbox mailbox(node, {node}, &id_mapper);
+  mailbox.ConnectAndBind();
+
+  Message msg;
+  msg.meta.sender = 234;
+  msg.meta.recver = 0;
+  msg.meta.model_id = 45;
+  msg.meta.flag = Flag::kGet;
+  msg.meta.clock = 7;
+  msg.meta.request_id = 12;
+  msg.AddData(third_party::SArray<Key>{1});
+
+  mailbox.Send(msg);
+  Message recv_msg;
+  mailbox.Recv(&recv_msg);
+  EXPECT_EQ(recv_msg.meta.clock, 7);
+  EXPECT_EQ(recv_msg.meta.request_id, 12);
+
+  mailbox.CloseSockets();
+}
+
 TEST_F(TestMailbox, Receiving) {
   Node node{0, "localhost", 32145};
   FakeIdMapper id_mapper;
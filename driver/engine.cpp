@@ -53,6 +53,8 @@ void Engine::StartWorkerThreads() {
   worker_helper_thread_.reset(new WorkerHelperThread(id_mapper_->GetWorkerHelperThreadsForId(node_.id)[0], 
                                               callback_runner_.get()));
   worker_helper_thread_->Start();
+  // the clocks of the node are sent in the name of the helper thread
+  clock_aggregator_.reset(new ClockAggregator(worker_helper_thread_->GetId(), sender_->GetMessageQueue()));
   DLOG(INFO) << "Engine " << node_.id << ":\tStart worker helper thread";
 }
 void Engine::StartMailbox() {
@@ -122,11 +124,17 @@ WorkerSpec Engine::AllocateWorkers(const std::vector<WorkerAlloc>& worker_alloc)
 
 void Engine::InitTable(uint32_t table_id, const std::vector<uint32_t>& worker_ids) {
   mailbox_->RegisterQueue(worker_helper_thread_->GetId(), worker_helper_thread_->GetWorkQueue());
+  worker_helper_thread_->resetMsgCounter();
   Message init_msg;
   init_msg.meta.flag = Flag::kResetWorkerInModel;
   init_msg.meta.sender = worker_helper_thread_->GetId();
   init_msg.meta.model_id = table_id;
   init_msg.AddData(third_party::SArray<uint32_t>(worker_ids));
+  if (clock_aggregated_tables_.count(table_id)) {
+    clock_aggregator_->InitTable(table_id, partition_manager_map_[table_id].get(), worker_ids);
+    init_msg.AddData(third_party::SArray<uint32_t>({clock_aggregator_->GetGroupId()}));
+  }
+  if (client_cached_tables_.count(table_id)) client_caches_[table_id].reset(new ClientCache());
   auto server_ids = id_mapper_->GetAllServerThreads();
   for (auto s_id : server_ids) {
     init_msg.meta.recver = s_id;
@@ -157,6 +165,11 @@ void Engine::Run(const MLTask& task) {
     for (auto it = partition_manager_map_.begin(); it != partition_manager_map_.end(); ++it) {
       info.partition_manager_map[it->first] = it->second.get();
     }
+    info.encoding_map = table_encoding_map_;
+    info.clock_aggregator = clock_aggregator_.get();
+    for (auto& cache : client_caches_) info.client_cache_map[cache.first] = cache.second.get();
+    info.add_buffer_map = add_buffer_configs_;
+    info.key_normalization_map = key_normalized_tables_;
     // use user thread id, and worker helper thread's queue
     mailbox_->RegisterQueue(tid, worker_helper_thread_->GetWorkQueue());
     std::thread udf_thread([&task, info] { task.RunLambda(info); });
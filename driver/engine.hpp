@@ -1,5 +1,7 @@
 #pragma once
 
+#include <set>
+#include <string>
 #include <vector>
 
 #include "base/abstract_partition_manager.hpp"
@@ -11,19 +13,56 @@
 #include "driver/worker_spec.hpp"
 #include "server/server_thread.hpp"
 #include "worker/abstract_callback_runner.hpp"
+#include "worker/add_buffer.hpp"
+#include "worker/clock_aggregator.hpp"
 #include "worker/worker_thread.hpp"
 
+#include "server/checkpoint_storage.hpp"
+#include "server/hash_storage.hpp"
 #include "server/map_storage.hpp"
+#include "server/mmap_storage.hpp"
+#include "server/optimizer/optimizers.hpp"
+#include "server/striped_storage.hpp"
+#include "server/util/initializer.hpp"
+#include "server/vector_storage.hpp"
+#include "server/consistency/adaptive_ssp_model.hpp"
 #include "server/consistency/asp_model.hpp"
+#include "server/consistency/backup_bsp_model.hpp"
 #include "server/consistency/bsp_model.hpp"
 #include "server/consistency/ssp_model.hpp"
+#include "server/consistency/value_bounded_model.hpp"
 #include "base/hash_partition_manager.h"
+#include "base/range_partition_manager.hpp"
 
 
 namespace csci5570 {
 
-enum class ModelType { SSP, BSP, ASP };
-enum class StorageType { Map };  // May have Vector
+enum class ModelType { SSP, BSP, ASP, AdaptiveSSP, BackupBSP, ValueBounded };
+enum class StorageType { Map, Vector, Hash, Mmap };  // Vector requires a RangePartitionManager
+
+/**
+ * Optional settings of a table
+ */
+struct TableConfig {
+  size_t storage_size_hint = 0;                 // the expected number of keys in the table, to reserve Hash storage
+  UpdateMode update_mode = UpdateMode::Assign;  // Accumulate lets workers push deltas instead of values
+  OptimizerConfig optimizer;                    // each Add is one gradient step on the servers, Vector and Hash only
+  size_t row_width = 1;                         // values per key, use KVClientTable::AddRows/GetRows if > 1
+  std::string mmap_dir;                         // where Mmap storage creates one file per server thread
+  std::string checkpoint_dir;                   // where to log checkpoints, one file per server thread, empty for none
+  int checkpoint_interval = 1;                  // the number of min clock advances between two checkpoints
+  bool restore_checkpoint = false;              // restore the table from the logs in checkpoint_dir when created
+  ValueEncoding value_encoding = ValueEncoding::Native;  // keep and send values with less precision than Val
+  InitializerConfig initializer;                         // the values of keys before their first Add
+  size_t num_shard_threads = 1;  // threads applying each large request to a shard, over as many key stripes
+  bool aggregate_clocks = false;  // send one clock per node to the servers instead of one per worker thread
+  AdaptiveStalenessConfig adaptive_staleness;  // the limits of AdaptiveSSP, which starts from model_staleness
+  BackupWorkerConfig backup_workers;            // how many stragglers BackupBSP leaves behind, and their Adds
+  ValueBoundConfig value_bound;                 // the per key bound of ValueBounded
+  bool client_cache = false;  // cache the values of an SSP table in each process, for Gets within the staleness
+  size_t add_buffer_bytes = 0;  // merge the Adds of a worker thread and send them at Clock or at this size, 0 for off
+  bool normalize_keys = false;  // sort and deduplicate the keys of each Get and Add on the workers
+};
 
 class Engine {
  public:
@@ -81,27 +120,55 @@ class Engine {
    * 1. Assign a table id (incremental and consecutive)
    * 2. Register the partition manager to the model
    * 3. For each local server thread maintained by the engine
-   *    a. Create a storage according to <storage_type>
+   *    a. Create a storage according to <storage_type>, a Vector storage covers the key range of the server thread
    *    b. Create a model according to <model_type>
    *    c. Register the model to the server thread
    *
    * @param partition_manager   the model partition manager
-   * @param model_type          the consistency of model - bsp, ssp, asp
-   * @param storage_type        the storage type - map, vector...
+   * @param model_type          the consistency of model - bsp, ssp, asp, adaptive ssp, bsp with backup workers,
+   *                            value bounded
+   * @param storage_type        the storage type - map, vector, hash, mmap
    * @param model_staleness     the staleness for ssp model
+   * @param config              optional table settings
    * @return                    the created table(model) id
    */
   template <typename Val>
   uint32_t CreateTable(std::unique_ptr<AbstractPartitionManager> partition_manager, ModelType model_type,
-                       StorageType storage_type, int model_staleness = 0) {
+                       StorageType storage_type, int model_staleness = 0, const TableConfig& config = TableConfig()) {
     auto model_id = model_count_++;
     RegisterPartitionManager(model_id, std::move(partition_manager));
+    table_encoding_map_[model_id] = config.value_encoding;
+    if (config.aggregate_clocks) clock_aggregated_tables_.insert(model_id);
+    if (config.client_cache) client_cached_tables_.insert(model_id);
+    // how workers combine Adds to a key, optimizers take Adds as gradients, which sum like accumulated deltas
+    auto combine_mode = config.optimizer.type == OptimizerType::None ? config.update_mode : UpdateMode::Accumulate;
+    if (config.add_buffer_bytes > 0) {
+      AddBufferConfig add_buffer;
+      add_buffer.mode = combine_mode;
+      add_buffer.max_bytes = config.add_buffer_bytes;
+      add_buffer_configs_[model_id] = add_buffer;
+    }
+    if (config.normalize_keys) key_normalized_tables_[model_id] = combine_mode;
+    CHECK(config.optimizer.type == OptimizerType::None || config.value_encoding == ValueEncoding::Native ||
+          config.value_encoding == ValueEncoding::Float32)
+        << "optimizer states need at least 32-bit values";
 
     for (int i = 0; i < server_thread_group_.size(); ++i) {
+      // the storage holds values in the encoding of the table
       std::unique_ptr<AbstractStorage> storage;
-      switch (storage_type) {
-        case StorageType::Map:
-          storage.reset(new MapStorage<Val>());
+      auto server_thread_id = server_thread_group_[i]->GetId();
+      switch (config.value_encoding) {
+        case ValueEncoding::Native:
+          storage = CreateStorage<Val>(model_id, server_thread_id, storage_type, config);
+          break;
+        case ValueEncoding::Float32:
+          storage = CreateStorage<float>(model_id, server_thread_id, storage_type, config);
+          break;
+        case ValueEncoding::Float16:
+          storage = CreateStorage<Half>(model_id, server_thread_id, storage_type, config);
+          break;
+        case ValueEncoding::BFloat16:
+          storage = CreateStorage<BFloat16>(model_id, server_thread_id, storage_type, config);
           break;
       }
 
@@ -116,6 +183,18 @@ class Engine {
         case ModelType::ASP:
           model.reset(new ASPModel(model_id, std::move(storage), sender_->GetMessageQueue()));
           break;
+        case ModelType::AdaptiveSSP:
+          model.reset(new AdaptiveSSPModel(model_id, std::move(storage), model_staleness, config.adaptive_staleness,
+                                           sender_->GetMessageQueue()));
+          break;
+        case ModelType::BackupBSP:
+          model.reset(new BackupBSPModel(model_id, std::move(storage), config.backup_workers,
+                                         sender_->GetMessageQueue()));
+          break;
+        case ModelType::ValueBounded:
+          model.reset(new ValueBoundedModel(model_id, std::move(storage), config.value_bound,
+                                            sender_->GetMessageQueue()));
+          break;
       }
       server_thread_group_[i]->RegisterModel(model_id, std::move(model));
     }
@@ -127,17 +206,20 @@ class Engine {
    * 1. Create a default partition manager
    * 2. Create a table with the partition manager
    *
-   * @param model_type          the consistency of model - bsp, ssp, asp
-   * @param storage_type        the storage type - map, vector...
+   * @param model_type          the consistency of model - bsp, ssp, asp, adaptive ssp, bsp with backup workers,
+   *                            value bounded
+   * @param storage_type        the storage type - map, vector, hash, mmap
    * @param model_staleness     the staleness for ssp model
+   * @param config              optional table settings
    * @return                    the created table(model) id
    */
   template <typename Val>
-  uint32_t CreateTable(ModelType model_type, StorageType storage_type, int model_staleness = 0) {
+  uint32_t CreateTable(ModelType model_type, StorageType storage_type, int model_staleness = 0,
+                       const TableConfig& config = TableConfig()) {
     std::unique_ptr<AbstractPartitionManager> partition_manager;
     auto local_server_tids = id_mapper_->GetServerThreadsForId(node_.id);
     partition_manager.reset(new HashPartitionManager(local_server_tids));
-    return CreateTable<Val>(std::move(partition_manager), model_type, storage_type, model_staleness);
+    return CreateTable<Val>(std::move(partition_manager), model_type, storage_type, model_staleness, config);
   }
 
   /**
@@ -160,6 +242,119 @@ class Engine {
   std::vector<uint32_t> GetServerThreadIds() { return id_mapper_->GetAllServerThreads(); }
 
  private:
+  /**
+   * Create the storage of a model on one local server thread, restored from its checkpoint log if configured
+   * The storage is striped when the table has more than one thread per shard
+   *
+   * @param model_id            the model id
+   * @param server_thread_id    the server thread to hold the storage
+   * @param storage_type        the storage type - map, vector, hash, mmap
+   * @param config              table settings
+   */
+  template <typename Val>
+  std::unique_ptr<AbstractStorage> CreateStorage(uint32_t model_id, uint32_t server_thread_id,
+                                                 StorageType storage_type, const TableConfig& config) {
+    CHECK_GT(config.num_shard_threads, 0);
+    auto* partition_manager = partition_manager_map_[model_id].get();
+    auto* range_manager = dynamic_cast<RangePartitionManager*>(partition_manager);
+    auto size_hint = config.storage_size_hint / partition_manager->GetNumServers();
+    std::unique_ptr<AbstractStorage> storage;
+    if (config.num_shard_threads == 1) {
+      auto range = range_manager != nullptr ? range_manager->GetRange(server_thread_id) : third_party::Range();
+      storage = CreateStripe<Val>(model_id, server_thread_id, storage_type, config, range_manager != nullptr, range,
+                                  size_hint, ".bin");
+    } else {
+      std::vector<std::unique_ptr<AbstractStorage>> stripes;
+      if (range_manager != nullptr) {
+        auto range = range_manager->GetRange(server_thread_id);
+        auto num_stripes = std::min<size_t>(config.num_shard_threads, std::max<size_t>(range.size(), 1));
+        auto stripe_ranges = StripedStorage::SplitRange(range, num_stripes);
+        for (size_t i = 0; i < num_stripes; ++i) {
+          stripes.push_back(CreateStripe<Val>(model_id, server_thread_id, storage_type, config, true,
+                                              stripe_ranges[i], size_hint / num_stripes,
+                                              "_stripe_" + std::to_string(i) + ".bin"));
+        }
+        storage.reset(new StripedStorage(std::move(stripes), range, config.num_shard_threads));
+      } else {
+        for (size_t i = 0; i < config.num_shard_threads; ++i) {
+          stripes.push_back(CreateStripe<Val>(model_id, server_thread_id, storage_type, config, false,
+                                              third_party::Range(), size_hint / config.num_shard_threads,
+                                              "_stripe_" + std::to_string(i) + ".bin"));
+        }
+        storage.reset(new StripedStorage(std::move(stripes), config.num_shard_threads));
+      }
+    }
+    if (!config.checkpoint_dir.empty()) {
+      auto path = ShardFileName(config.checkpoint_dir, model_id, server_thread_id, ".ckpt");
+      storage.reset(new CheckpointStorage(std::move(storage), path, config.checkpoint_interval,
+                                          config.restore_checkpoint));
+    }
+    return storage;
+  }
+
+  /**
+   * Create a storage for the keys of a shard or of one stripe of it
+   *
+   * @param ranged              whether <range> is the key range to cover, required by Vector storage
+   * @param size_hint           the expected number of keys
+   * @param mmap_extension      the end of the name of the file of Mmap storage
+   */
+  template <typename Val>
+  std::unique_ptr<AbstractStorage> CreateStripe(uint32_t model_id, uint32_t server_thread_id,
+                                                StorageType storage_type, const TableConfig& config, bool ranged,
+                                                const third_party::Range& range, size_t size_hint,
+                                                const std::string& mmap_extension) {
+    Initializer initializer(config.initializer);
+    std::unique_ptr<AbstractStorage> storage;
+    switch (storage_type) {
+      case StorageType::Map: {
+        CHECK(config.optimizer.type == OptimizerType::None) << "optimizers require Vector or Hash storage";
+        CHECK_EQ(config.row_width, 1) << "rows require Vector or Hash storage";
+        auto* map_storage = new MapStorage<Val>(config.update_mode);
+        map_storage->SetInitializer(initializer);
+        storage.reset(map_storage);
+        break;
+      }
+      case StorageType::Vector: {
+        CHECK(ranged) << "Vector storage requires a RangePartitionManager";
+        auto* vector_storage = new VectorStorage<Val>(range, config.update_mode, config.row_width);
+        vector_storage->SetOptimizer(CreateOptimizer<Val>(config.optimizer));
+        vector_storage->SetInitializer(initializer);
+        storage.reset(vector_storage);
+        break;
+      }
+      case StorageType::Hash: {
+        auto* hash_storage = new HashStorage<Val>(size_hint, config.update_mode, config.row_width);
+        hash_storage->SetOptimizer(CreateOptimizer<Val>(config.optimizer));
+        hash_storage->SetInitializer(initializer);
+        storage.reset(hash_storage);
+        break;
+      }
+      case StorageType::Mmap: {
+        CHECK(config.optimizer.type == OptimizerType::None) << "optimizers require Vector or Hash storage";
+        CHECK(!config.mmap_dir.empty()) << "Mmap storage requires TableConfig::mmap_dir";
+        auto path = ShardFileName(config.mmap_dir, model_id, server_thread_id, mmap_extension);
+        // index densely when the key range is known, otherwise by hashing
+        MmapStorage<Val>* mmap_storage;
+        if (ranged) {
+          mmap_storage = new MmapStorage<Val>(path, range, config.update_mode, config.row_width);
+        } else {
+          mmap_storage = new MmapStorage<Val>(path, size_hint, config.update_mode, config.row_width);
+        }
+        mmap_storage->SetInitializer(initializer);
+        storage.reset(mmap_storage);
+        break;
+      }
+    }
+    return storage;
+  }
+
+  // the file of a model shard held by a server thread
+  static std::string ShardFileName(const std::string& dir, uint32_t model_id, uint32_t server_thread_id,
+                                   const std::string& extension) {
+    return dir + "/table_" + std::to_string(model_id) + "_server_" + std::to_string(server_thread_id) + extension;
+  }
+
   /**
    * Register partition manager for a model to the engine
    *
@@ -169,6 +364,12 @@ class Engine {
   void RegisterPartitionManager(uint32_t table_id, std::unique_ptr<AbstractPartitionManager> partition_manager);
 
   std::map<uint32_t, std::unique_ptr<AbstractPartitionManager>> partition_manager_map_;
+  std::map<uint32_t, ValueEncoding> table_encoding_map_;
+  std::set<uint32_t> clock_aggregated_tables_;
+  std::set<uint32_t> client_cached_tables_;
+  std::map<uint32_t, std::unique_ptr<ClientCache>> client_caches_;  // created for each task, as clocks restart
+  std::map<uint32_t, AddBufferConfig> add_buffer_configs_;
+  std::map<uint32_t, UpdateMode> key_normalized_tables_;  // table id -> how the rows of a key in an Add combine
   // nodes
   Node node_;
   std::vector<Node> nodes_;
@@ -179,6 +380,7 @@ class Engine {
   // worker elements
   std::unique_ptr<AbstractCallbackRunner> callback_runner_;
   std::unique_ptr<WorkerHelperThread> worker_helper_thread_;
+  std::unique_ptr<ClockAggregator> clock_aggregator_;
   // server elements
   std::vector<std::unique_ptr<ServerThread>> server_thread_group_;
   size_t model_count_ = 0;
@@ -151,5 +151,409 @@ TEST_F(TestEngine, KVClientTableMapStorage) {
   engine.StopEverything();
 }
 
+TEST_F(TestEngine, KVClientTableVectorStorage) {
+  Node node{0, "localhost", 12353};
+  Engine engine(node, {node});
+  // start
+  engine.StartEverything();
+
+  // add range
+  auto server_tids = engine.GetServerThreadIds();
+  ASSERT_EQ(server_tids.size(), 1);
+  std::unique_ptr<AbstractPartitionManager> range_manager(new RangePartitionManager(server_tids, {{0, 10}}));
+  const auto kTableId =
+      engine.CreateTable<double>(std::move(range_manager), ModelType::SSP, StorageType::Vector);  // table 0
+  engine.Barrier();
+  MLTask task;
+  task.SetWorkerAlloc({{0, 3}});  // 3 workers on node 0
+  task.SetTables({kTableId});     // Use table 0
+  task.SetLambda([kTableId](const Info& info) {
+    KVClientTable<double> table = info.CreateKVClientTable<double>(kTableId);
+    for (int i = 0; i < 5; ++i) {
+      std::vector<Key> keys{1, 9};
+      std::vector<double> vals{0.5, 0.5};
+      table.Add(keys, vals);
+      std::vector<double> ret;
+      table.Get(keys, &ret);
+      EXPECT_EQ(ret.size(), 2);
+    }
+  });
+  engine.Run(task);
+
+  // stop
+  engine.StopEverything();
+}
+
+TEST_F(TestEngine, KVClientTableHashStorage) {
+  Node node{0, "localhost", 12353};
+  Engine engine(node, {node});
+  // start
+  engine.StartEverything();
+
+  TableConfig config;
+  config.storage_size_hint = 1000;
+  const auto kTableId = engine.CreateTable<double>(ModelType::SSP, StorageType::Hash, 0, config);  // table 0
+  engine.Barrier();
+  MLTask task;
+  task.SetWorkerAlloc({{0, 3}});  // 3 workers on node 0
+  task.SetTables({kTableId});     // Use table 0
+  task.SetLambda([kTableId](const Info& info) {
+    KVClientTable<double> table = info.CreateKVClientTable<double>(kTableId);
+    for (int i = 0; i < 5; ++i) {
+      std::vector<Key> keys{1, 100000};
+      std::vector<double> vals{0.5, 0.5};
+      table.Add(keys, vals);
+      std::vector<double> ret;
+      table.Get(keys, &ret);
+      EXPECT_EQ(ret.size(), 2);
+    }
+  });
+  engine.Run(task);
+
+  // stop
+  engine.StopEverything();
+}
+
+TEST_F(TestEngine, KVClientTableOptimizer) {
+  Node node{0, "localhost", 12354};
+  Engine engine(node, {node});
+  // start
+  engine.StartEverything();
+
+  TableConfig config;
+  config.optimizer.type = OptimizerType::SGD;
+  config.optimizer.learning_rate = 0.1;
+  const auto kTableId = engine.CreateTable<double>(ModelType::BSP, StorageType::Hash, 0, config);  // table 0
+  engine.Barrier();
+  MLTask task;
+  task.SetWorkerAlloc({{0, 1}});  // 1 worker on node 0
+  task.SetTables({kTableId});     // Use table 0
+  task.SetLambda([kTableId](const Info& info) {
+    KVClientTable<double> table = info.CreateKVClientTable<double>(kTableId);
+    std::vector<Key> keys{1, 100000};
+    std::vector<double> grads{1.0, -2.0};
+    table.Add(keys, grads);
+    table.Clock();
+    std::vector<double> ret;
+    table.Get(keys, &ret);
+    ASSERT_EQ(ret.size(), 2);
+    EXPECT_DOUBLE_EQ(ret[0], -0.1);
+    EXPECT_DOUBLE_EQ(ret[1], 0.2);
+    table.Clock();
+  });
+  engine.Run(task);
+
+  // stop
+  engine.StopEverything();
+}
+
+TEST_F(TestEngine, KVClientTableRows) {
+  Node node{0, "localhost", 12355};
+  Engine engine(node, {node});
+  // start
+  engine.StartEverything();
+
+  TableConfig config;
+  config.row_width = 4;
+  const auto kTableId = engine.CreateTable<float>(ModelType::ASP, StorageType::Hash, 0, config);  // table 0
+  engine.Barrier();
+  MLTask task;
+  task.SetWorkerAlloc({{0, 1}});  // 1 worker on node 0
+  task.SetTables({kTableId});     // Use table 0
+  task.SetLambda([kTableId](const Info& info) {
+    KVClientTable<float> table = info.CreateKVClientTable<float>(kTableId);
+    std::vector<Key> keys{100000, 1};
+    std::vector<float> rows{1, 2, 3, 4, 5, 6, 7, 8};
+    table.AddRows(keys, rows);
+    std::vector<float> ret;
+    table.GetRows(keys, &ret);
+    EXPECT_EQ(ret, rows);
+    table.Clock();
+  });
+  engine.Run(task);
+
+  // stop
+  engine.StopEverything();
+}
+
+TEST_F(TestEngine, KVClientTableMmapStorage) {
+  Node node{0, "localhost", 12356};
+  Engine engine(node, {node});
+  // start
+  engine.StartEverything();
+
+  TableConfig config;
+  config.mmap_dir = "/tmp";
+  const auto kTableId = engine.CreateTable<double>(ModelType::ASP, StorageType::Mmap, 0, config);  // table 0
+  engine.Barrier();
+  MLTask task;
+  task.SetWorkerAlloc({{0, 1}});  // 1 worker on node 0
+  task.SetTables({kTableId});     // Use table 0
+  task.SetLambda([kTableId](const Info& info) {
+    KVClientTable<double> table = info.CreateKVClientTable<double>(kTableId);
+    std::vector<Key> keys{1};
+    std::vector<double> vals{0.5};
+    table.Add(keys, vals);
+    std::vector<double> ret;
+    table.Get(keys, &ret);
+    EXPECT_EQ(ret, vals);
+    table.Clock();
+  });
+  engine.Run(task);
+
+  // stop
+  engine.StopEverything();
+}
+
+TEST_F(TestEngine, CheckpointRestore) {
+  Node node{0, "localhost", 12357};
+  TableConfig config;
+  config.checkpoint_dir = "/tmp";
+  config.update_mode = UpdateMode::Accumulate;
+  for (int run = 0; run < 2; ++run) {
+    Engine engine(node, {node});
+    engine.StartEverything();
+    config.restore_checkpoint = run == 1;
+    const auto kTableId = engine.CreateTable<double>(ModelType::BSP, StorageType::Map, 0, config);  // table 0
+    engine.Barrier();
+    MLTask task;
+    task.SetWorkerAlloc({{0, 1}});  // 1 worker on node 0
+    task.SetTables({kTableId});     // Use table 0
+    task.SetLambda([kTableId, run](const Info& info) {
+      KVClientTable<double> table = info.CreateKVClientTable<double>(kTableId);
+      std::vector<Key> keys{1};
+      std::vector<double> vals{0.5};
+      table.Add(keys, vals);
+      table.Clock();  // applies the add and checkpoints it
+      std::vector<double> ret;
+      table.Get(keys, &ret);
+      ASSERT_EQ(ret.size(), 1);
+      EXPECT_DOUBLE_EQ(ret[0], 0.5 * (run + 1));  // the second run starts from the checkpoint of the first
+    });
+    engine.Run(task);
+    engine.StopEverything();
+  }
+}
+
+TEST_F(TestEngine, KVClientTableBFloat16) {
+  Node node{0, "localhost", 12358};
+  Engine engine(node, {node});
+  // start
+  engine.StartEverything();
+
+  TableConfig config;
+  config.value_encoding = ValueEncoding::BFloat16;
+  config.update_mode = UpdateMode::Accumulate;
+  const auto kTableId = engine.CreateTable<double>(ModelType::ASP, StorageType::Hash, 0, config);  // table 0
+  engine.Barrier();
+  MLTask task;
+  task.SetWorkerAlloc({{0, 1}});  // 1 worker on node 0
+  task.SetTables({kTableId});     // Use table 0
+  task.SetLambda([kTableId](const Info& info) {
+    KVClientTable<double> table = info.CreateKVClientTable<double>(kTableId);
+    std::vector<Key> keys{1, 100000};
+    table.Add(keys, std::vector<double>{0.5, 1.25});
+    table.Add(keys, std::vector<double>{0.5, 1.25});
+    std::vector<double> ret;
+    table.Get(keys, &ret);
+    ASSERT_EQ(ret.size(), 2);
+    EXPECT_DOUBLE_EQ(ret[0] + ret[1], 3.5);
+    table.Clock();
+  });
+  engine.Run(task);
+
+  // stop
+  engine.StopEverything();
+}
+
+TEST_F(TestEngine, KVClientTableStripedStorage) {
+  Node node{0, "localhost", 12359};
+  Engine engine(node, {node});
+  engine.StartEverything();
+
+  auto server_tids = engine.GetServerThreadIds();
+  ASSERT_EQ(server_tids.size(), 1);
+  std::unique_ptr<AbstractPartitionManager> range_manager(new RangePartitionManager(server_tids, {{0, 4000}}));
+  TableConfig config;
+  config.update_mode = UpdateMode::Accumulate;
+  config.num_shard_threads = 4;
+  const auto kTableId = engine.CreateTable<double>(std::move(range_manager), ModelType::BSP, StorageType::Vector, 0,
+                                                   config);  // table 0
+  engine.Barrier();
+  MLTask task;
+  task.SetWorkerAlloc({{0, 2}});  // 2 workers on node 0
+  task.SetTables({kTableId});     // Use table 0
+  task.SetLambda([kTableId](const Info& info) {
+    KVClientTable<double> table = info.CreateKVClientTable<double>(kTableId);
+    std::vector<Key> keys;
+    for (Key k = 0; k < 4000; ++k) keys.push_back(k);
+    std::vector<double> vals(keys.size(), 0.5);
+    table.Add(keys, vals);
+    table.Clock();
+    std::vector<double> ret;
+    table.Get(keys, &ret);
+    ASSERT_EQ(ret.size(), keys.size());
+    for (auto v : ret) EXPECT_DOUBLE_EQ(v, 1);
+  });
+  engine.Run(task);
+
+  engine.StopEverything();
+}
+
+TEST_F(TestEngine, AggregatedClocks) {
+  Node node{0, "localhost", 12360};
+  Engine engine(node, {node});
+  engine.StartEverything();
+
+  TableConfig config;
+  config.update_mode = UpdateMode::Accumulate;
+  config.aggregate_clocks = true;
+  const auto kTableId = engine.CreateTable<double>(ModelType::BSP, StorageType::Map, 0, config);  // table 0
+  engine.Barrier();
+  MLTask task;
+  task.SetWorkerAlloc({{0, 3}});  // 3 workers on node 0
+  task.SetTables({kTableId});     // Use table 0
+  task.SetLambda([kTableId](const Info& info) {
+    KVClientTable<double> table = info.CreateKVClientTable<double>(kTableId);
+    std::vector<Key> keys{1};
+    for (int i = 0; i < 5; ++i) {
+      table.Add(keys, std::vector<double>{1});
+      table.Clock();
+      // BSP: after clock i every worker sees the Adds of all clocks up to i
+      std::vector<double> ret;
+      table.Get(keys, &ret);
+      ASSERT_EQ(ret.size(), 1);
+      EXPECT_DOUBLE_EQ(ret[0], 3 * (i + 1));
+    }
+  });
+  engine.Run(task);
+
+  engine.StopEverything();
+}
+
+TEST_F(TestEngine, KVClientTableGet) {
+  Node node{0, "localhost", 12361};
+  Engine engine(node, {node});
+  engine.StartEverything(2);  // the keys are spread over 2 server threads
+
+  const auto kTableId = engine.CreateTable<double>(ModelType::ASP, StorageType::Map);  // table 0
+  engine.Barrier();
+  MLTask task;
+  task.SetWorkerAlloc({{0, 2}});  // 2 workers on node 0
+  task.SetTables({kTableId});     // Use table 0
+  task.SetLambda([kTableId](const Info& info) {
+    KVClientTable<double> table = info.CreateKVClientTable<double>(kTableId);
+    std::vector<Key> keys{7, 2, 9, 4, 1};
+    table.Add(keys, std::vector<double>{0.7, 0.2, 0.9, 0.4, 0.1});  // both workers assign the same values
+    // the values come back in the order of keys, whichever server replies first
+    std::vector<double> ret;
+    table.Get(keys, &ret);
+    EXPECT_EQ(ret, std::vector<double>({0.7, 0.2, 0.9, 0.4, 0.1}));
+    std::vector<double> buffer(2);
+    table.GetInto(third_party::SArray<Key>{9, 2}, buffer.data(), buffer.size());
+    EXPECT_EQ(buffer, std::vector<double>({0.9, 0.2}));
+    auto first = table.GetAsync(third_party::SArray<Key>{4, 7});
+    auto second = table.GetAsync(third_party::SArray<Key>{1});
+    auto vals = first.get();
+    EXPECT_EQ(std::vector<double>(vals.begin(), vals.end()), std::vector<double>({0.4, 0.7}));
+    vals = second.get();
+    EXPECT_EQ(std::vector<double>(vals.begin(), vals.end()), std::vector<double>({0.1}));
+  });
+  engine.Run(task);
+
+  engine.StopEverything();
+}
+
+TEST_F(TestEngine, KVClientTableSubscribe) {
+  Node node{0, "localhost", 12362};
+  Engine engine(node, {node});
+  engine.StartEverything(2);
+
+  TableConfig config;
+  config.update_mode = UpdateMode::Accumulate;
+  const auto kTableId = engine.CreateTable<double>(ModelType::SSP, StorageType::Map, 0, config);  // table 0
+  engine.Barrier();
+  MLTask task;
+  task.SetWorkerAlloc({{0, 2}});  // 2 workers on node 0
+  task.SetTables({kTableId});     // Use table 0
+  task.SetLambda([kTableId](const Info& info) {
+    KVClientTable<double> table = info.CreateKVClientTable<double>(kTableId);
+    std::vector<Key> keys{1, 2, 3};
+    table.Subscribe(keys);
+    for (int i = 0; i < 4; ++i) {
+      table.Add(keys, std::vector<double>{1, 1, 1});
+      table.Clock();
+      // staleness 0: the values pushed at the min clock advance to i + 1 hold the Adds of both workers
+      std::vector<double> ret;
+      table.Get(keys, &ret);
+      EXPECT_EQ(ret, std::vector<double>(3, 2 * (i + 1)));
+    }
+  });
+  engine.Run(task);
+
+  engine.StopEverything();
+}
+
+TEST_F(TestEngine, ClientCache) {
+  Node node{0, "localhost", 12363};
+  Engine engine(node, {node});
+  engine.StartEverything();
+
+  TableConfig config;
+  config.update_mode = UpdateMode::Accumulate;
+  config.client_cache = true;
+  const auto kTableId = engine.CreateTable<double>(ModelType::SSP, StorageType::Map, 2, config);  // table 0
+  engine.Barrier();
+  MLTask task;
+  task.SetWorkerAlloc({{0, 1}});  // 1 worker on node 0
+  task.SetTables({kTableId});     // Use table 0
+  task.SetLambda([kTableId](const Info& info) {
+    KVClientTable<double> table = info.CreateKVClientTable<double>(kTableId);
+    auto* cache = info.client_cache_map.at(kTableId);
+    std::vector<Key> keys{1, 2};
+    std::vector<double> ret;
+    table.Get(keys, &ret);
+    table.Get(keys, &ret);
+    EXPECT_EQ(cache->GetNumHits(), 2);  // the values fetched at clock 0 may be read until clock 2
+    // the thread reads its own Add within the staleness
+    table.Add(std::vector<Key>{1}, std::vector<double>{0.5});
+    ret.clear();
+    table.Get(keys, &ret);
+    EXPECT_EQ(ret, std::vector<double>({0.5, 0}));
+    EXPECT_EQ(cache->GetNumHits(), 3);
+  });
+  engine.Run(task);
+
+  engine.StopEverything();
+}
+
+TEST_F(TestEngine, AddBuffer) {
+  Node node{0, "localhost", 12364};
+  Engine engine(node, {node});
+  engine.StartEverything(2);
+
+  TableConfig config;
+  config.update_mode = UpdateMode::Accumulate;
+  config.add_buffer_bytes = 1 << 20;
+  const auto kTableId = engine.CreateTable<double>(ModelType::ASP, StorageType::Map, 0, config);  // table 0
+  engine.Barrier();
+  MLTask task;
+  task.SetWorkerAlloc({{0, 1}});  // 1 worker on node 0
+  task.SetTables({kTableId});     // Use table 0
+  task.SetLambda([kTableId](const Info& info) {
+    KVClientTable<double> table = info.CreateKVClientTable<double>(kTableId);
+    std::vector<Key> keys{3, 8, 1};
+    for (int i = 0; i < 3; ++i) table.Add(keys, std::vector<double>{1, 2, 3});
+    // the buffer is sent before the Get, which the servers answer after the Adds of the same worker
+    std::vector<double> ret;
+    table.Get(keys, &ret);
+    EXPECT_EQ(ret, std::vector<double>({3, 6, 9}));
+    table.Clock();
+  });
+  engine.Run(task);
+
+  engine.StopEverything();
+}
+
 }  // namespace
 }  // namespace csci5570
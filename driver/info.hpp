@@ -5,6 +5,8 @@
 #include "base/abstract_partition_manager.hpp"
 #include "base/threadsafe_queue.hpp"
 #include "worker/abstract_callback_runner.hpp"
+#include "worker/add_buffer.hpp"
+#include "worker/clock_aggregator.hpp"
 #include "worker/kv_client_table.hpp"
 
 #include "glog/logging.h"
@@ -19,7 +21,12 @@ struct Info {
   uint32_t worker_id;
   ThreadsafeQueue<Message>* send_queue;
   std::map<uint32_t, AbstractPartitionManager*> partition_manager_map;
+  std::map<uint32_t, ValueEncoding> encoding_map;  // tables not in the map use ValueEncoding::Native
   AbstractCallbackRunner* callback_runner;
+  ClockAggregator* clock_aggregator = nullptr;     // tables it does not aggregate clock the servers directly
+  std::map<uint32_t, ClientCache*> client_cache_map;  // the tables cached by the process
+  std::map<uint32_t, AddBufferConfig> add_buffer_map;  // the tables whose Adds are buffered by the worker threads
+  std::map<uint32_t, UpdateMode> key_normalization_map;  // the tables whose keys are sorted and deduplicated
 
   std::string DebugString() const {
     std::stringstream ss;
@@ -36,7 +43,19 @@ struct Info {
   template <typename Val>
   KVClientTable<Val> CreateKVClientTable(uint32_t table_id) const {
     const auto partition_manager = partition_manager_map.at(table_id);// not found will throw exception
-    return KVClientTable<Val>(thread_id, table_id, send_queue, partition_manager, callback_runner);
+    auto it = encoding_map.find(table_id);
+    auto encoding = it == encoding_map.end() ? ValueEncoding::Native : it->second;
+    auto* aggregator = clock_aggregator != nullptr && clock_aggregator->HasTable(table_id) ? clock_aggregator : nullptr;
+    auto cache = client_cache_map.find(table_id);
+    KVClientTable<Val> table(thread_id, table_id, send_queue, partition_manager, callback_runner, encoding, aggregator,
+                             cache == client_cache_map.end() ? nullptr : cache->second);
+    auto add_buffer = add_buffer_map.find(table_id);
+    if (add_buffer != add_buffer_map.end()) {
+      table.EnableAddBuffer(add_buffer->second.mode, add_buffer->second.max_bytes);
+    }
+    auto normalization = key_normalization_map.find(table_id);
+    if (normalization != key_normalization_map.end()) table.EnableKeyNormalization(normalization->second);
+    return table;
   }
 };
 
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <cinttypes>
+#include <vector>
 #include "base/message.hpp"
 #include "base/threadsafe_queue.hpp"
 
+#include "glog/logging.h"
+
 namespace csci5570 {
 
 class AbstractModel {
@@ -11,8 +14,17 @@ class AbstractModel {
   virtual void Clock(Message& msg) = 0;
   virtual void Add(Message& msg) = 0;
   virtual void Get(Message& msg) = 0;
+  // the Adds to the model that arrived between two Clocks, in the order they arrived
+  virtual void AddBatch(std::vector<Message>& msgs) {
+    for (auto& msg : msgs) Add(msg);
+  }
   virtual int GetProgress(int tid) = 0;
   virtual void ResetWorker(Message& msg) = 0;
+  // register the keys of a worker to be pushed to it whenever they change, for models that push values
+  virtual void Subscribe(Message& msg) {
+    LOG(WARNING) << "model " << msg.meta.model_id << " does not push values, ignores the subscription of worker "
+                 << msg.meta.sender;
+  }
   virtual ~AbstractModel() {}
 };
 
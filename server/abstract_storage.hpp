@@ -4,6 +4,9 @@
 
 #include "glog/logging.h"
 
+#include <memory>
+#include <vector>
+
 namespace csci5570 {
 
 /*
@@ -11,6 +14,8 @@ namespace csci5570 {
  */
 class AbstractStorage {
  public:
+  virtual ~AbstractStorage() {}
+
   void Add(Message& msg) {
     CHECK(msg.data.size() == 2);
     auto typed_keys = third_party::SArray<Key>(msg.data[0]);
@@ -24,12 +29,26 @@ class AbstractStorage {
     reply.meta.sender = msg.meta.recver;
     reply.meta.flag = msg.meta.flag;
     reply.meta.model_id = msg.meta.model_id;
+    reply.meta.request_id = msg.meta.request_id;
     third_party::SArray<Key> reply_keys(typed_keys);
     third_party::SArray<char> reply_vals = SubGet(reply_keys);
     reply.AddData<Key>(reply_keys);
     reply.AddData<char>(reply_vals);
     return reply;
   }
+  // Apply several Adds through a delta, which merges the updates to the same key before they reach the storage
+  void AddBatch(std::vector<Message>& msgs) {
+    if (msgs.size() == 1) {
+      Add(msgs[0]);
+      return;
+    }
+    if (msgs.empty()) return;
+    auto delta = CreateDelta();
+    for (auto& msg : msgs) delta->Add(msg);
+    MergeDelta(*delta);
+  }
+  // Apply all the Adds collected in a delta created by CreateDelta
+  void MergeDelta(const AbstractStorage& delta) { delta.ApplyTo(this); }
   
   // Add the typed_keys and typed_vals to kvstore
   virtual void SubAdd(const third_party::SArray<Key>& typed_keys, 
@@ -38,6 +57,28 @@ class AbstractStorage {
   // Retrieve the vals according to the typed_keys
   virtual third_party::SArray<char> SubGet(const third_party::SArray<Key>& typed_keys) = 0;
 
+  // Overwrite the vals of the typed_keys, regardless of the update mode or optimizer, e.g. to restore a checkpoint
+  virtual void SubAssign(const third_party::SArray<Key>& typed_keys,
+      const third_party::SArray<char>& vals) = 0;
+
+  // Create an empty storage to collect Adds that are applied later by MergeDelta, one value per key, or one Add
+  // after the other for a storage with an optimizer, whose every Add is one optimizer step
+  virtual std::unique_ptr<AbstractStorage> CreateDelta() const = 0;
+
+  // Apply the Adds collected in this storage to <storage> in one SubAdd, only needed by the storages returned by
+  // CreateDelta
+  virtual void ApplyTo(AbstractStorage* storage) const {
+    third_party::SArray<Key> typed_keys;
+    third_party::SArray<char> vals;
+    SubDump(&typed_keys, &vals);
+    if (!typed_keys.empty()) storage->SubAdd(typed_keys, vals);
+  }
+
+  // Retrieve all the keys and vals, only needed by the storages returned by CreateDelta
+  virtual void SubDump(third_party::SArray<Key>* typed_keys, third_party::SArray<char>* vals) const {
+    LOG(FATAL) << "this storage cannot be dumped";
+  }
+
   virtual void FinishIter() = 0;
 };
 
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "base/message.hpp"
+#include "server/abstract_storage.hpp"
+
+#include "glog/logging.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace csci5570 {
+
+/**
+ * The delta of a storage with an optimizer
+ *
+ * An Add to such a storage is the gradient of one optimizer step, so summing the Adds of a clock into one value
+ * per key would take one step instead of several. The delta keeps the Adds in their order instead, and merging it
+ * applies them one by one.
+ */
+class AddLogStorage : public AbstractStorage {
+ public:
+  virtual void SubAdd(const third_party::SArray<Key>& typed_keys, const third_party::SArray<char>& vals) override {
+    log_.emplace_back(typed_keys, vals);
+  }
+
+  virtual third_party::SArray<char> SubGet(const third_party::SArray<Key>& typed_keys) override {
+    LOG(FATAL) << "the Adds of an optimizer are not readable before they are merged";
+    return third_party::SArray<char>();
+  }
+
+  virtual void SubAssign(const third_party::SArray<Key>& typed_keys, const third_party::SArray<char>& vals) override {
+    LOG(FATAL) << "the Adds of an optimizer cannot be assigned";
+  }
+
+  virtual std::unique_ptr<AbstractStorage> CreateDelta() const override {
+    return std::unique_ptr<AbstractStorage>(new AddLogStorage());
+  }
+
+  virtual void ApplyTo(AbstractStorage* storage) const override {
+    for (auto& add : log_) storage->SubAdd(add.first, add.second);
+  }
+
+  virtual void FinishIter() override {}
+
+  size_t GetNumAdds() const { return log_.size(); }
+
+ private:
+  std::vector<std::pair<third_party::SArray<Key>, third_party::SArray<char>>> log_;
+};
+
+}  // namespace csci5570
@@ -0,0 +1,82 @@
+#include "server/checkpoint_storage.hpp"
+
+#include "glog/logging.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace csci5570 {
+
+CheckpointStorage::CheckpointStorage(std::unique_ptr<AbstractStorage>&& storage, const std::string& path,
+                                     int interval, bool restore)
+    : storage_(std::move(storage)), path_(path), interval_(interval) {
+  CHECK_GT(interval_, 0);
+  if (restore) Restore();
+  log_.open(path_, restore ? std::ios::binary | std::ios::app : std::ios::binary | std::ios::trunc);
+  CHECK(log_.is_open()) << "cannot open checkpoint log " << path_;
+}
+
+void CheckpointStorage::SubAdd(const third_party::SArray<Key>& typed_keys, const third_party::SArray<char>& vals) {
+  dirty_keys_.insert(typed_keys.begin(), typed_keys.end());
+  storage_->SubAdd(typed_keys, vals);
+}
+
+third_party::SArray<char> CheckpointStorage::SubGet(const third_party::SArray<Key>& typed_keys) {
+  return storage_->SubGet(typed_keys);
+}
+
+void CheckpointStorage::SubAssign(const third_party::SArray<Key>& typed_keys, const third_party::SArray<char>& vals) {
+  dirty_keys_.insert(typed_keys.begin(), typed_keys.end());
+  storage_->SubAssign(typed_keys, vals);
+}
+
+std::unique_ptr<AbstractStorage> CheckpointStorage::CreateDelta() const {
+  // merging the delta goes through SubAdd, which marks the keys dirty
+  return storage_->CreateDelta();
+}
+
+void CheckpointStorage::FinishIter() {
+  storage_->FinishIter();
+  if (++num_iters_ % interval_ == 0) Checkpoint();
+}
+
+void CheckpointStorage::Checkpoint() {
+  if (dirty_keys_.empty()) return;
+  // sorted keys read the storage in order, and make the log deterministic
+  third_party::SArray<Key> keys(dirty_keys_.size());
+  std::copy(dirty_keys_.begin(), dirty_keys_.end(), keys.begin());
+  std::sort(keys.begin(), keys.end());
+  third_party::SArray<char> vals = storage_->SubGet(keys);
+
+  RecordHeader header{kRecordMagic, static_cast<uint32_t>(keys.size()), static_cast<uint64_t>(vals.size())};
+  log_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  log_.write(reinterpret_cast<const char*>(keys.data()), keys.size() * sizeof(Key));
+  log_.write(vals.data(), vals.size());
+  log_.flush();
+  CHECK(log_.good()) << "failed to write checkpoint log " << path_;
+  dirty_keys_.clear();
+}
+
+void CheckpointStorage::Restore() {
+  std::ifstream in(path_, std::ios::binary);
+  if (!in.is_open()) return;
+  std::streamoff valid_end = 0;
+  RecordHeader header;
+  while (in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+    if (header.magic != kRecordMagic) break;
+    third_party::SArray<Key> keys(header.num_keys);
+    third_party::SArray<char> vals(header.val_bytes);
+    if (!in.read(reinterpret_cast<char*>(keys.data()), keys.size() * sizeof(Key))) break;
+    if (!in.read(vals.data(), vals.size())) break;
+    storage_->SubAssign(keys, vals);
+    valid_end = in.tellg();
+    ++num_restored_records_;
+  }
+  in.close();
+  // cut a torn tail, so that new records are appended right after the last complete one
+  if (truncate(path_.c_str(), valid_end) != 0) LOG(WARNING) << "cannot truncate checkpoint log " << path_;
+}
+
+}  // namespace csci5570
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "base/message.hpp"
+#include "server/abstract_storage.hpp"
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+namespace csci5570 {
+
+/**
+ * Wraps a storage and checkpoints it incrementally into a log file of the shard
+ *
+ * The keys updated since the last checkpoint are tracked, and every <interval> calls of FinishIter
+ * (that is, min clock advances of the model) their current values are appended to the log as one record:
+ *
+ *   | magic (uint32) | number of keys (uint32) | bytes of values (uint64) | keys | values |
+ *
+ * Restoring replays the records in order, so later records overwrite earlier ones. A record cut short by
+ * a crash is dropped together with everything after it.
+ */
+class CheckpointStorage : public AbstractStorage {
+ public:
+  /**
+   * @param storage     the storage to checkpoint
+   * @param path        the log file of the shard
+   * @param interval    the number of FinishIter calls between two checkpoints
+   * @param restore     whether to restore the storage from an existing log, otherwise the log is truncated
+   */
+  CheckpointStorage(std::unique_ptr<AbstractStorage>&& storage, const std::string& path, int interval,
+                    bool restore);
+
+  virtual void SubAdd(const third_party::SArray<Key>& typed_keys, const third_party::SArray<char>& vals) override;
+  virtual third_party::SArray<char> SubGet(const third_party::SArray<Key>& typed_keys) override;
+  virtual void SubAssign(const third_party::SArray<Key>& typed_keys, const third_party::SArray<char>& vals) override;
+  virtual std::unique_ptr<AbstractStorage> CreateDelta() const override;
+  virtual void FinishIter() override;
+
+  /**
+   * Append the values of the dirty keys to the log
+   */
+  void Checkpoint();
+
+  size_t GetNumDirtyKeys() const { return dirty_keys_.size(); }
+  // the number of records replayed by the restore at construction
+  size_t GetNumRestoredRecords() const { return num_restored_records_; }
+
+ private:
+  static const uint32_t kRecordMagic = 0x43504b54;
+
+  struct RecordHeader {
+    uint32_t magic;
+    uint32_t num_keys;
+    uint64_t val_bytes;
+  };
+
+  void Restore();
+
+  std::unique_ptr<AbstractStorage> storage_;
+  std::string path_;
+  int interval_;
+  int num_iters_ = 0;
+  size_t num_restored_records_ = 0;
+  std::unordered_set<Key> dirty_keys_;
+  std::ofstream log_;
+};
+
+}  // namespace csci5570
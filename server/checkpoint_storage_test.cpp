@@ -0,0 +1,93 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/checkpoint_storage.hpp"
+#include "server/hash_storage.hpp"
+#include "server/map_storage.hpp"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace csci5570 {
+namespace {
+
+class TestCheckpointStorage : public testing::Test {
+ public:
+  TestCheckpointStorage() {}
+  ~TestCheckpointStorage() {}
+
+ protected:
+  void SetUp() { path_ = "/tmp/csci5570_checkpoint_storage_test_" + std::to_string(getpid()); }
+  void TearDown() { std::remove(path_.c_str()); }
+
+  std::string path_;
+};
+
+TEST_F(TestCheckpointStorage, DirtyKeys) {
+  CheckpointStorage s(std::unique_ptr<AbstractStorage>(new MapStorage<int>()), path_, 2, false);
+  third_party::SArray<Key> keys({3, 1, 3});
+  third_party::SArray<int> vals({1, 2, 3});
+  s.SubAdd(keys, third_party::SArray<char>(vals));
+  EXPECT_EQ(s.GetNumDirtyKeys(), 2);
+  s.FinishIter();
+  EXPECT_EQ(s.GetNumDirtyKeys(), 2);  // checkpoint every 2 iterations
+  s.FinishIter();
+  EXPECT_EQ(s.GetNumDirtyKeys(), 0);
+}
+
+TEST_F(TestCheckpointStorage, Restore) {
+  {
+    // accumulated values are restored as they are, not added again
+    std::unique_ptr<AbstractStorage> storage(new HashStorage<double>(0, UpdateMode::Accumulate, 2));
+    CheckpointStorage s(std::move(storage), path_, 1, false);
+    third_party::SArray<Key> keys({10, 20});
+    third_party::SArray<double> vals({1.0, 2.0, 3.0, 4.0});
+    s.SubAdd(keys, third_party::SArray<char>(vals));
+    s.FinishIter();
+    third_party::SArray<Key> keys2({20});
+    s.SubAdd(keys2, third_party::SArray<char>(third_party::SArray<double>({0.5, 0.5})));
+    s.FinishIter();
+    // not checkpointed yet
+    s.SubAdd(keys2, third_party::SArray<char>(third_party::SArray<double>({100.0, 100.0})));
+  }
+  std::unique_ptr<AbstractStorage> storage(new HashStorage<double>(0, UpdateMode::Accumulate, 2));
+  CheckpointStorage s(std::move(storage), path_, 1, true);
+  EXPECT_EQ(s.GetNumRestoredRecords(), 2);
+  auto ret = third_party::SArray<double>(s.SubGet(third_party::SArray<Key>({10, 20})));
+  ASSERT_EQ(ret.size(), 4);
+  EXPECT_DOUBLE_EQ(ret[0], 1.0);
+  EXPECT_DOUBLE_EQ(ret[1], 2.0);
+  EXPECT_DOUBLE_EQ(ret[2], 3.5);
+  EXPECT_DOUBLE_EQ(ret[3], 4.5);
+}
+
+TEST_F(TestCheckpointStorage, TornRecord) {
+  {
+    CheckpointStorage s(std::unique_ptr<AbstractStorage>(new MapStorage<int>()), path_, 1, false);
+    s.SubAdd(third_party::SArray<Key>({1}), third_party::SArray<char>(third_party::SArray<int>({7})));
+    s.FinishIter();
+  }
+  {
+    // a crash in the middle of writing a record
+    std::ofstream out(path_, std::ios::binary | std::ios::app);
+    out.write("\x54\x4b\x50\x43\x05", 5);
+  }
+  {
+    CheckpointStorage s(std::unique_ptr<AbstractStorage>(new MapStorage<int>()), path_, 1, true);
+    EXPECT_EQ(s.GetNumRestoredRecords(), 1);
+    s.SubAdd(third_party::SArray<Key>({2}), third_party::SArray<char>(third_party::SArray<int>({8})));
+    s.FinishIter();
+  }
+  CheckpointStorage s(std::unique_ptr<AbstractStorage>(new MapStorage<int>()), path_, 1, true);
+  EXPECT_EQ(s.GetNumRestoredRecords(), 2);
+  auto ret = third_party::SArray<int>(s.SubGet(third_party::SArray<Key>({1, 2})));
+  ASSERT_EQ(ret.size(), 2);
+  EXPECT_EQ(ret[0], 7);
+  EXPECT_EQ(ret[1], 8);
+}
+
+}  // namespace
+}  // namespace csci5570
@@ -0,0 +1,84 @@
+#include "server/consistency/adaptive_ssp_model.hpp"
+#include "glog/logging.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace csci5570 {
+
+AdaptiveSSPModel::AdaptiveSSPModel(uint32_t model_id, std::unique_ptr<AbstractStorage>&& storage_ptr,
+                                   int staleness, const AdaptiveStalenessConfig& config,
+                                   ThreadsafeQueue<Message>* reply_queue)
+    : SSPModel(model_id, std::move(storage_ptr), staleness, reply_queue), config_(config) {
+  CHECK_LE(config_.min_staleness, config_.max_staleness);
+  CHECK_GT(config_.adjust_interval, 0);
+  staleness_ = std::min(std::max(staleness_, config_.min_staleness), config_.max_staleness);
+  now_ = [] {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  };
+}
+
+void AdaptiveSSPModel::Clock(Message& msg) {
+  if (!progress_tracker_.CheckThreadValid(msg.meta.sender)) return;
+  RecordClock(msg.meta.sender);
+  int min_clock = progress_tracker_.GetMinClock();
+  SSPModel::Clock(msg);
+  if (progress_tracker_.GetMinClock() != min_clock &&
+      progress_tracker_.GetMinClock() % config_.adjust_interval == 0) {
+    Adjust();
+  }
+}
+
+void AdaptiveSSPModel::RecordClock(int tid) {
+  double now = now_();
+  auto& rate = rates_[tid];
+  if (rate.has_clocked) {
+    double interval = now - rate.last_clock_time;
+    rate.interval = rate.interval == 0
+                        ? interval
+                        : config_.rate_smoothing * interval + (1 - config_.rate_smoothing) * rate.interval;
+  }
+  rate.has_clocked = true;
+  rate.last_clock_time = now;
+}
+
+void AdaptiveSSPModel::Adjust() {
+  std::vector<double> intervals;
+  intervals.reserve(rates_.size());
+  for (auto& pair : rates_) {
+    if (pair.second.interval > 0) intervals.push_back(pair.second.interval);
+  }
+  if (intervals.size() < 2) return;
+  auto median = intervals.begin() + intervals.size() / 2;
+  std::nth_element(intervals.begin(), median, intervals.end());
+  double median_interval = *median;
+  double slowest_interval = *std::max_element(intervals.begin(), intervals.end());
+
+  int staleness = staleness_;
+  if (slowest_interval >= config_.widen_ratio * median_interval) {
+    staleness = std::min(staleness_ + 1, config_.max_staleness);
+  } else if (slowest_interval <= config_.narrow_ratio * median_interval) {
+    staleness = std::max(staleness_ - 1, config_.min_staleness);
+  }
+  if (staleness == staleness_) return;
+
+  StalenessAdjustment adjustment{progress_tracker_.GetMinClock(), staleness_, staleness, median_interval,
+                                 slowest_interval};
+  adjustments_.push_back(adjustment);
+  LOG(INFO) << "model " << model_id_ << " at min clock " << adjustment.min_clock << ": staleness "
+            << adjustment.old_staleness << " -> " << adjustment.new_staleness << " (median " << median_interval
+            << "s, slowest " << slowest_interval << "s per clock)";
+  SetStaleness(staleness);
+}
+
+void AdaptiveSSPModel::SetStaleness(int staleness) {
+  int widened_by = staleness - staleness_;
+  staleness_ = staleness;
+  // a Get of a worker at clock c waits in the bucket of clock c - old staleness
+  if (widened_by <= 0 || buffer_.Size() == 0) return;
+  std::vector<Message> pending_msgs;
+  buffer_.PopUpTo(progress_tracker_.GetMinClock() + widened_by, &pending_msgs);
+  for (auto& pending : pending_msgs) Get(pending);
+}
+
+}  // namespace csci5570
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "server/consistency/ssp_model.hpp"
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace csci5570 {
+
+/**
+ * The limits and policy of an adaptive staleness bound
+ */
+struct AdaptiveStalenessConfig {
+  int min_staleness = 0;
+  int max_staleness = 8;
+  int adjust_interval = 1;       // the number of min clock advances between two adjustments
+  double widen_ratio = 2.0;      // widen by one when the slowest worker clocks this much slower than the median
+  double narrow_ratio = 1.25;    // narrow by one when the slowest worker is within this ratio of the median
+  double rate_smoothing = 0.5;   // the weight of the latest interval in the moving average of a worker
+};
+
+/**
+ * A change of the staleness bound, and the clock intervals that caused it
+ */
+struct StalenessAdjustment {
+  int min_clock;
+  int old_staleness;
+  int new_staleness;
+  double median_interval;   // seconds per clock of the median worker
+  double slowest_interval;  // seconds per clock of the slowest worker
+};
+
+/**
+ * A model with Stale Synchronous Parallel consistency whose staleness bound follows the stragglers
+ *
+ * The model keeps a moving average of the time between two clocks of each worker (or clock group). Every
+ * adjust_interval advances of the min clock it compares the slowest worker with the median one. A straggler
+ * widens the bound so that the other workers do not stall behind it, and workers clocking at similar rates
+ * narrow it again to keep reads fresh. Each adjustment is logged and kept in GetAdjustments.
+ */
+class AdaptiveSSPModel : public SSPModel {
+ public:
+  AdaptiveSSPModel(uint32_t model_id, std::unique_ptr<AbstractStorage>&& storage_ptr, int staleness,
+                   const AdaptiveStalenessConfig& config, ThreadsafeQueue<Message>* reply_queue);
+
+  virtual void Clock(Message& msg) override;
+
+  int GetStaleness() const { return staleness_; }
+  const std::vector<StalenessAdjustment>& GetAdjustments() const { return adjustments_; }
+
+  // replace the clock the intervals are measured with, in seconds
+  void SetTimeSource(const std::function<double()>& now) { now_ = now; }
+
+ private:
+  struct ClockRate {
+    double last_clock_time = 0;
+    double interval = 0;  // the moving average, 0 until the second clock
+    bool has_clocked = false;
+  };
+
+  void RecordClock(int tid);
+  void Adjust();
+  // widening releases the Gets that the new bound lets through
+  void SetStaleness(int staleness);
+
+  AdaptiveStalenessConfig config_;
+  std::function<double()> now_;
+  std::unordered_map<int, ClockRate> rates_;  // tid of a clock source -> its clock rate
+  std::vector<StalenessAdjustment> adjustments_;
+};
+
+}  // namespace csci5570
@@ -0,0 +1,110 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "base/threadsafe_queue.hpp"
+#include "server/consistency/adaptive_ssp_model.hpp"
+#include "server/consistency/model_test_util.hpp"
+#include "server/map_storage.hpp"
+
+namespace csci5570 {
+namespace {
+
+class TestAdaptiveSSPModel : public testing::Test {
+ public:
+  TestAdaptiveSSPModel() {}
+  ~TestAdaptiveSSPModel() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+TEST_F(TestAdaptiveSSPModel, WidenForStraggler) {
+  ThreadsafeQueue<Message> reply_queue;
+  AdaptiveStalenessConfig config;
+  config.min_staleness = 0;
+  config.max_staleness = 2;
+  std::unique_ptr<AbstractStorage> storage(new MapStorage<int>());
+  AdaptiveSSPModel model(0, std::move(storage), 1, config, &reply_queue);
+  double now = 0;
+  model.SetTimeSource([&now] { return now; });
+  ResetWorkers(&model, {2, 3, 4}, &reply_queue);
+
+  for (int tid : {2, 3, 4}) {
+    auto m = MakeMessage(Flag::kClock, tid);
+    model.Clock(m);
+  }
+  // workers 2 and 3 clock every second, 4 is three times slower
+  for (int clock = 2; clock <= 4; ++clock) {
+    now += 1;
+    for (int tid : {2, 3}) {
+      auto m = MakeMessage(Flag::kClock, tid);
+      model.Clock(m);
+    }
+  }
+  // worker 2 is at clock 4, 3 clocks ahead of the min clock
+  auto get = MakeGet(2, 0);
+  model.Get(get);
+  EXPECT_EQ(reply_queue.Size(), 0);
+  EXPECT_EQ(model.GetPendingSize(3), 1);
+
+  now += 0.5;
+  auto m = MakeMessage(Flag::kClock, 4);
+  model.Clock(m);
+  EXPECT_EQ(model.GetProgress(4), 2);
+  EXPECT_EQ(model.GetStaleness(), 2);
+  ASSERT_EQ(model.GetAdjustments().size(), 1);
+  auto adjustment = model.GetAdjustments()[0];
+  EXPECT_EQ(adjustment.min_clock, 2);
+  EXPECT_EQ(adjustment.old_staleness, 1);
+  EXPECT_EQ(adjustment.new_staleness, 2);
+  EXPECT_DOUBLE_EQ(adjustment.median_interval, 1);
+  EXPECT_DOUBLE_EQ(adjustment.slowest_interval, 3.5);
+
+  // the wider bound lets the Get of clock 4 through at min clock 2
+  EXPECT_EQ(model.GetPendingSize(3), 0);
+  Message reply;
+  reply_queue.WaitAndPop(&reply);
+  EXPECT_EQ(reply.meta.flag, Flag::kGet);
+  EXPECT_EQ(reply.meta.recver, 2);
+}
+
+TEST_F(TestAdaptiveSSPModel, NarrowWithinLimits) {
+  ThreadsafeQueue<Message> reply_queue;
+  AdaptiveStalenessConfig config;
+  config.min_staleness = 1;
+  config.max_staleness = 4;
+  std::unique_ptr<AbstractStorage> storage(new MapStorage<int>());
+  AdaptiveSSPModel model(0, std::move(storage), 3, config, &reply_queue);
+  double now = 0;
+  model.SetTimeSource([&now] { return now; });
+  ResetWorkers(&model, {2, 3, 4}, &reply_queue);
+
+  // workers clocking at the same rate narrow the bound by one per min clock, down to the lower limit
+  for (int clock = 1; clock <= 5; ++clock) {
+    for (int tid : {2, 3, 4}) {
+      auto m = MakeMessage(Flag::kClock, tid);
+      model.Clock(m);
+    }
+    now += 1;
+  }
+  EXPECT_EQ(model.GetStaleness(), 1);
+  ASSERT_EQ(model.GetAdjustments().size(), 2);
+  EXPECT_EQ(model.GetAdjustments()[0].min_clock, 2);
+  EXPECT_EQ(model.GetAdjustments()[0].new_staleness, 2);
+  EXPECT_EQ(model.GetAdjustments()[1].min_clock, 3);
+  EXPECT_EQ(model.GetAdjustments()[1].new_staleness, 1);
+}
+
+TEST_F(TestAdaptiveSSPModel, ClampInitialStaleness) {
+  ThreadsafeQueue<Message> reply_queue;
+  AdaptiveStalenessConfig config;
+  config.min_staleness = 2;
+  config.max_staleness = 4;
+  std::unique_ptr<AbstractStorage> storage(new MapStorage<int>());
+  AdaptiveSSPModel model(0, std::move(storage), 0, config, &reply_queue);
+  EXPECT_EQ(model.GetStaleness(), 2);
+}
+
+}  // namespace
+}  // namespace csci5570
@@ -8,8 +8,8 @@ ASPModel::ASPModel(uint32_t model_id, std::unique_ptr<AbstractStorage>&& storage
                                                           reply_queue_(reply_queue) {}
 
 void ASPModel::Clock(Message& msg) {
-  if (progress_tracker_.CheckThreadValid(msg.meta.sender))
-    progress_tracker_.AdvanceAndGetChangedMinClock(msg.meta.sender);
+  if (!progress_tracker_.CheckThreadValid(msg.meta.sender)) return;
+  if (progress_tracker_.AdvanceAndGetChangedMinClock(msg.meta.sender) != -1) storage_->FinishIter();
 }
 
 void ASPModel::Add(Message& msg) {
@@ -17,6 +17,15 @@ void ASPModel::Add(Message& msg) {
     storage_->Add(msg);
 }
 
+void ASPModel::AddBatch(std::vector<Message>& msgs) {
+  std::vector<Message> valid_msgs;
+  valid_msgs.reserve(msgs.size());
+  for (auto& msg : msgs) {
+    if (progress_tracker_.CheckThreadValid(msg.meta.sender)) valid_msgs.push_back(msg);
+  }
+  storage_->AddBatch(valid_msgs);
+}
+
 void ASPModel::Get(Message& msg) {
   if (progress_tracker_.CheckThreadValid(msg.meta.sender))
     reply_queue_->Push(storage_->Get(msg));
@@ -29,7 +38,13 @@ int ASPModel::GetProgress(int tid) {
 void ASPModel::ResetWorker(Message& msg) {
   // convert char[] to uint32_t !!!!!!
   third_party::SArray<uint32_t> tids(msg.data[0]);
-  progress_tracker_.Init(std::vector<uint32_t>(tids.begin(), tids.end()));
+  if (msg.data.size() > 1) {
+    // the workers clock as a group, through the clock aggregator of their node
+    third_party::SArray<uint32_t> group(msg.data[1]);
+    progress_tracker_.InitGroup(group[0], std::vector<uint32_t>(tids.begin(), tids.end()));
+  } else {
+    progress_tracker_.Init(std::vector<uint32_t>(tids.begin(), tids.end()));
+  }
   Message reply;
   reply.meta.flag = Flag::kResetWorkerInModel;
   reply.meta.model_id = msg.meta.model_id;
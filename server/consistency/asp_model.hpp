@@ -22,6 +22,7 @@ class ASPModel : public AbstractModel {
   virtual void Clock(Message& msg) override;
   virtual void Add(Message& msg) override;
   virtual void Get(Message& msg) override;
+  virtual void AddBatch(std::vector<Message>& msgs) override;
   virtual int GetProgress(int tid) override;
   virtual void ResetWorker(Message& msg) override;
 
@@ -0,0 +1,95 @@
+#include "server/consistency/backup_bsp_model.hpp"
+#include "glog/logging.h"
+
+#include <algorithm>
+
+namespace csci5570 {
+
+BackupBSPModel::BackupBSPModel(uint32_t model_id, std::unique_ptr<AbstractStorage>&& storage_ptr,
+                               const BackupWorkerConfig& config, ThreadsafeQueue<Message>* reply_queue)
+    : model_id_(model_id), config_(config), reply_queue_(reply_queue), storage_(std::move(storage_ptr)) {
+  CHECK_GE(config_.num_backup_workers, 0);
+}
+
+void BackupBSPModel::Clock(Message& msg) {
+  if (!progress_tracker_.CheckThreadValid(msg.meta.sender)) return;
+  int finished = GetProgress(msg.meta.sender);
+  progress_tracker_.AdvanceAndGetChangedMinClock(msg.meta.sender);
+  // a straggler finishing a closed clock does not count towards the open ones
+  if (finished < closed_clock_) return;
+  ++num_finished_[finished];
+  int quorum = std::max(progress_tracker_.GetNumThreads() - config_.num_backup_workers, 1);
+  while (num_finished_[closed_clock_] >= quorum) CloseClock();
+}
+
+void BackupBSPModel::CloseClock() {
+  auto delta = add_deltas_.find(closed_clock_);
+  if (delta != add_deltas_.end()) {
+    storage_->MergeDelta(*delta->second);
+    add_deltas_.erase(delta);
+  }
+  num_finished_.erase(closed_clock_);
+  ++closed_clock_;
+  std::vector<Message> still_pending;
+  for (auto& pending : get_buffer_) {
+    if (SenderClock(pending) <= closed_clock_) {
+      reply_queue_->Push(storage_->Get(pending));
+    } else {
+      still_pending.push_back(std::move(pending));
+    }
+  }
+  get_buffer_.swap(still_pending);
+  storage_->FinishIter();
+}
+
+void BackupBSPModel::Add(Message& msg) {
+  if (!progress_tracker_.CheckThreadValid(msg.meta.sender)) return;
+  int clock = SenderClock(msg);
+  if (clock < closed_clock_) {
+    if (config_.late_adds == LateAddPolicy::Drop) {
+      ++num_dropped_adds_;
+      return;
+    }
+    ++num_folded_adds_;
+    clock = closed_clock_;
+  }
+  auto& delta = add_deltas_[clock];
+  if (!delta) delta = storage_->CreateDelta();
+  delta->Add(msg);
+}
+
+void BackupBSPModel::Get(Message& msg) {
+  if (!progress_tracker_.CheckThreadValid(msg.meta.sender)) return;
+  if (SenderClock(msg) > closed_clock_) {
+    get_buffer_.push_back(msg);
+  } else {
+    reply_queue_->Push(storage_->Get(msg));
+  }
+}
+
+int BackupBSPModel::GetProgress(int tid) {
+  return progress_tracker_.GetProgress(tid);
+}
+
+int BackupBSPModel::SenderClock(const Message& msg) {
+  return msg.meta.clock >= 0 ? msg.meta.clock : GetProgress(msg.meta.sender);
+}
+
+void BackupBSPModel::ResetWorker(Message& msg) {
+  third_party::SArray<uint32_t> tids(msg.data[0]);
+  if (msg.data.size() > 1) {
+    // the workers clock as a group, through the clock aggregator of their node
+    third_party::SArray<uint32_t> group(msg.data[1]);
+    progress_tracker_.InitGroup(group[0], std::vector<uint32_t>(tids.begin(), tids.end()));
+  } else {
+    progress_tracker_.Init(std::vector<uint32_t>(tids.begin(), tids.end()));
+  }
+  Message reply;
+  reply.meta.flag = Flag::kResetWorkerInModel;
+  reply.meta.model_id = msg.meta.model_id;
+  reply.meta.recver = msg.meta.sender;
+  reply.meta.sender = msg.meta.recver;
+  reply_queue_->Push(reply);
+}
+
+}  // namespace csci5570
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "server/abstract_model.hpp"
+
+#include "base/message.hpp"
+#include "base/threadsafe_queue.hpp"
+#include "server/abstract_storage.hpp"
+#include "server/util/progress_tracker.hpp"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace csci5570 {
+
+// what happens to the Adds of a clock that closed without their worker
+enum class LateAddPolicy { Drop, FoldIntoNext };
+
+/**
+ * The settings of BSP with backup workers
+ */
+struct BackupWorkerConfig {
+  int num_backup_workers = 1;  // the number of clock sources a clock may close without
+  LateAddPolicy late_adds = LateAddPolicy::Drop;
+};
+
+/**
+ * A model with Batch Synchronous Parallel consistency that does not wait for its slowest k workers
+ *
+ * A clock closes once all but num_backup_workers clock sources (worker threads, or nodes that aggregate their
+ * clocks) have finished it: its Adds are merged and the Gets of the next clock are replied. The Adds that the
+ * stragglers send for a closed clock are dropped, or folded into the clock that is open by then, and counted
+ * either way. A straggler is never blocked, its Gets read the latest closed clock, so it catches up at the
+ * pace of its own computation.
+ */
+class BackupBSPModel : public AbstractModel {
+ public:
+  BackupBSPModel(uint32_t model_id, std::unique_ptr<AbstractStorage>&& storage_ptr, const BackupWorkerConfig& config,
+                 ThreadsafeQueue<Message>* reply_queue);
+
+  virtual void Clock(Message& msg) override;
+  virtual void Add(Message& msg) override;
+  virtual void Get(Message& msg) override;
+  virtual int GetProgress(int tid) override;
+  virtual void ResetWorker(Message& msg) override;
+
+  // the number of clocks closed so far, the clock of the version in the storage
+  int GetClosedClock() const { return closed_clock_; }
+  int GetNumDroppedAdds() const { return num_dropped_adds_; }
+  int GetNumFoldedAdds() const { return num_folded_adds_; }
+  int GetGetPendingSize() const { return get_buffer_.size(); }
+
+ private:
+  // the clock of the worker sending an Add or Get, carried by the message when its node aggregates clocks
+  int SenderClock(const Message& msg);
+  void CloseClock();
+
+  uint32_t model_id_;
+  BackupWorkerConfig config_;
+
+  ThreadsafeQueue<Message>* reply_queue_;
+  std::unique_ptr<AbstractStorage> storage_;
+  ProgressTracker progress_tracker_;
+  int closed_clock_ = 0;
+  std::map<int, int> num_finished_;  // clock c -> the number of clock sources with progress > c, for open clocks
+  std::map<int, std::unique_ptr<AbstractStorage>> add_deltas_;  // the Adds of each open clock
+  std::vector<Message> get_buffer_;                              // the Gets of workers ahead of the closed clock
+  int num_dropped_adds_ = 0;
+  int num_folded_adds_ = 0;
+};
+
+}  // namespace csci5570
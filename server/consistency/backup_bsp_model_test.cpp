@@ -0,0 +1,102 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "base/threadsafe_queue.hpp"
+#include "server/consistency/backup_bsp_model.hpp"
+#include "server/consistency/model_test_util.hpp"
+#include "server/map_storage.hpp"
+
+namespace csci5570 {
+namespace {
+
+class TestBackupBSPModel : public testing::Test {
+ public:
+  TestBackupBSPModel() {}
+  ~TestBackupBSPModel() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+std::unique_ptr<BackupBSPModel> CreateModel(LateAddPolicy policy, ThreadsafeQueue<Message>* reply_queue) {
+  BackupWorkerConfig config;
+  config.num_backup_workers = 1;
+  config.late_adds = policy;
+  std::unique_ptr<AbstractStorage> storage(new MapStorage<int>(UpdateMode::Accumulate));
+  std::unique_ptr<BackupBSPModel> model(new BackupBSPModel(0, std::move(storage), config, reply_queue));
+  ResetWorkers(model.get(), {2, 3, 4}, reply_queue);
+  return model;
+}
+
+TEST_F(TestBackupBSPModel, CloseWithoutStraggler) {
+  ThreadsafeQueue<Message> reply_queue;
+  auto model = CreateModel(LateAddPolicy::Drop, &reply_queue);
+  for (int tid : {2, 3, 4}) {
+    auto add = MakeAdd(tid, 0, 1);
+    model->Add(add);
+  }
+  auto clock = MakeMessage(Flag::kClock, 2);
+  model->Clock(clock);
+  auto get = MakeGet(2, 0);
+  model->Get(get);
+  EXPECT_EQ(model->GetGetPendingSize(), 1);
+
+  // 2 of 3 workers finished clock 0, worker 4 is left behind
+  clock = MakeMessage(Flag::kClock, 3);
+  model->Clock(clock);
+  EXPECT_EQ(model->GetClosedClock(), 1);
+  EXPECT_EQ(PopValue(&reply_queue), 3);
+
+  // the straggler is not blocked, and its Add of clock 0 is dropped
+  get = MakeGet(4, 0);
+  model->Get(get);
+  EXPECT_EQ(PopValue(&reply_queue), 3);
+  auto add = MakeAdd(4, 0, 10);
+  model->Add(add);
+  EXPECT_EQ(model->GetNumDroppedAdds(), 1);
+  clock = MakeMessage(Flag::kClock, 4);
+  model->Clock(clock);
+  EXPECT_EQ(model->GetClosedClock(), 1);
+
+  // clock 1 closes with worker 4 in the quorum
+  clock = MakeMessage(Flag::kClock, 4);
+  model->Clock(clock);
+  clock = MakeMessage(Flag::kClock, 2);
+  model->Clock(clock);
+  EXPECT_EQ(model->GetClosedClock(), 2);
+  get = MakeGet(2, 0);
+  model->Get(get);
+  EXPECT_EQ(PopValue(&reply_queue), 3);
+}
+
+TEST_F(TestBackupBSPModel, FoldLateAdds) {
+  ThreadsafeQueue<Message> reply_queue;
+  auto model = CreateModel(LateAddPolicy::FoldIntoNext, &reply_queue);
+  for (int tid : {2, 3}) {
+    auto clock = MakeMessage(Flag::kClock, tid);
+    model->Clock(clock);
+  }
+  EXPECT_EQ(model->GetClosedClock(), 1);
+
+  // the late Add of worker 4 goes into the open clock 1
+  auto add = MakeAdd(4, 0, 10);
+  model->Add(add);
+  EXPECT_EQ(model->GetNumFoldedAdds(), 1);
+  EXPECT_EQ(model->GetNumDroppedAdds(), 0);
+  auto get = MakeGet(4, 0);
+  model->Get(get);
+  EXPECT_EQ(PopValue(&reply_queue), 0);
+
+  for (int tid : {2, 3}) {
+    auto clock = MakeMessage(Flag::kClock, tid);
+    model->Clock(clock);
+  }
+  EXPECT_EQ(model->GetClosedClock(), 2);
+  get = MakeGet(2, 0);
+  model->Get(get);
+  EXPECT_EQ(PopValue(&reply_queue), 10);
+}
+
+}  // namespace
+}  // namespace csci5570
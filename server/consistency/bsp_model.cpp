@@ -12,27 +12,39 @@ void BSPModel::Clock(Message& msg) {
   if (GetProgress(msg.meta.sender) > progress_tracker_.GetMinClock()) return;//thread which is ahead should not clock
 
   int cur_mini_clock = progress_tracker_.AdvanceAndGetChangedMinClock(msg.meta.sender);
-  if (cur_mini_clock != -1) {// min_clock changed, process all buffered msg
-    for (auto pendingMsg : add_buffer_) {
-      storage_->Add(pendingMsg);
+  if (cur_mini_clock != -1) {// min_clock changed, merge the adds of the finished clocks and reply the buffered gets
+    while (!add_deltas_.empty() && add_deltas_.begin()->first < cur_mini_clock) {
+      storage_->MergeDelta(*add_deltas_.begin()->second);
+      num_pending_adds_.erase(add_deltas_.begin()->first);
+      add_deltas_.erase(add_deltas_.begin());
     }
-    for (auto pendingMsg : get_buffer_) {
-      reply_queue_->Push(storage_->Get(pendingMsg));
+    std::vector<Message> still_pending;
+    for (auto& pendingMsg : get_buffer_) {
+      if (SenderClock(pendingMsg) <= cur_mini_clock) {
+        reply_queue_->Push(storage_->Get(pendingMsg));
+      } else {
+        still_pending.push_back(std::move(pendingMsg));
+      }
     }
-    add_buffer_.clear();
-    get_buffer_.clear();
+    get_buffer_.swap(still_pending);
+    storage_->FinishIter();
   }
 }
 
 void BSPModel::Add(Message& msg) {
   if (!progress_tracker_.CheckThreadValid(msg.meta.sender)) return;
-  add_buffer_.push_back(msg);// collect all the add msgs, they are processed when the min_clock advances
+  // collect the add into the delta of the clock of the sender, it is merged when the min_clock passes the clock
+  int clock = SenderClock(msg);
+  auto& delta = add_deltas_[clock];
+  if (!delta) delta = storage_->CreateDelta();
+  delta->Add(msg);
+  ++num_pending_adds_[clock];
 }
 
 void BSPModel::Get(Message& msg) {
   if (!progress_tracker_.CheckThreadValid(msg.meta.sender)) return;
   // if current thread's clock is ahead, its get msgs are buffered
-  if (progress_tracker_.GetMinClock() < GetProgress(msg.meta.sender)) get_buffer_.push_back(msg);
+  if (progress_tracker_.GetMinClock() < SenderClock(msg)) get_buffer_.push_back(msg);
   else reply_queue_->Push(storage_->Get(msg));
 }
 
@@ -40,18 +52,30 @@ int BSPModel::GetProgress(int tid) {
   return progress_tracker_.GetProgress(tid);
 }
 
+int BSPModel::SenderClock(const Message& msg) {
+  return msg.meta.clock >= 0 ? msg.meta.clock : GetProgress(msg.meta.sender);
+}
+
 int BSPModel::GetGetPendingSize() {
   return get_buffer_.size();
 }
 
 int BSPModel::GetAddPendingSize() {
-  return add_buffer_.size();
+  int num_adds = 0;
+  for (auto& pending : num_pending_adds_) num_adds += pending.second;
+  return num_adds;
 }
 
 void BSPModel::ResetWorker(Message& msg) {
   // convert char[] to uint32_t !!!!!!
   third_party::SArray<uint32_t> tids(msg.data[0]);
-  progress_tracker_.Init(std::vector<uint32_t>(tids.begin(), tids.end()));
+  if (msg.data.size() > 1) {
+    // the workers clock as a group, through the clock aggregator of their node
+    third_party::SArray<uint32_t> group(msg.data[1]);
+    progress_tracker_.InitGroup(group[0], std::vector<uint32_t>(tids.begin(), tids.end()));
+  } else {
+    progress_tracker_.Init(std::vector<uint32_t>(tids.begin(), tids.end()));
+  }
   Message relpy;
   relpy.meta.flag = Flag::kResetWorkerInModel;
   relpy.meta.model_id = msg.meta.model_id;
@@ -13,6 +13,11 @@ namespace csci5570 {
 
 /**
  * A wrapper for model with Batch Synchronous Parallel consistency
+ *
+ * The Adds of each clock in flight are collected in a delta storage of the clock. The delta of a clock is merged
+ * into the storage when the min clock passes it, and the storage always holds the version that workers at the
+ * min clock read. A worker clocking through the aggregator of its node sends Adds tagged with its own clock, which
+ * may be several clocks ahead of the min clock.
  */
 class BSPModel : public AbstractModel {
  public:
@@ -29,13 +34,17 @@ class BSPModel : public AbstractModel {
   int GetAddPendingSize();
 
  private:
+  // the clock of the worker sending an Add or Get, carried by the message when its node aggregates clocks
+  int SenderClock(const Message& msg);
+
   uint32_t model_id_;
 
   ThreadsafeQueue<Message>* reply_queue_;
   std::unique_ptr<AbstractStorage> storage_;
   ProgressTracker progress_tracker_;
-  std::vector<Message> get_buffer_;  // buffer of get requests
-  std::vector<Message> add_buffer_;  // buffer of add requests
+  std::vector<Message> get_buffer_;                // buffer of get requests
+  std::map<int, std::unique_ptr<AbstractStorage>> add_deltas_;  // the Adds of each clock not passed by the min clock
+  std::map<int, int> num_pending_adds_;                          // the number of Adds collected in each delta
 };
 
 }  // namespace csci5570
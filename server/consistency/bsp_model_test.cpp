@@ -4,6 +4,10 @@
 #include "base/threadsafe_queue.hpp"
 #include "server/consistency/bsp_model.hpp"
 #include "server/map_storage.hpp"
+#include "server/optimizer/optimizers.hpp"
+#include "server/vector_storage.hpp"
+
+#include <cmath>
 
 namespace csci5570 {
 namespace {
@@ -129,5 +133,157 @@ TEST_F(TestBSPModel, CheckGetAndAdd) {
   EXPECT_EQ(rep_vals2[0], 100);
 }
 
+TEST_F(TestBSPModel, AddsOfAheadWorker) {
+  ThreadsafeQueue<Message> reply_queue;
+  std::unique_ptr<AbstractStorage> storage(new MapStorage<int>(UpdateMode::Accumulate));
+  std::unique_ptr<AbstractModel> model(new BSPModel(0, std::move(storage), &reply_queue));
+  Message reset_msg;
+  reset_msg.AddData(third_party::SArray<uint32_t>({2, 3}));
+  model->ResetWorker(reset_msg);
+  Message reply;
+  reply_queue.WaitAndPop(&reply);
+
+  auto make_msg = [](Flag flag, uint32_t sender, int val) {
+    Message m;
+    m.meta.flag = flag;
+    m.meta.sender = sender;
+    if (flag != Flag::kClock) m.AddData(third_party::SArray<Key>({1}));
+    if (flag == Flag::kAdd) m.AddData(third_party::SArray<int>({val}));
+    return m;
+  };
+  auto get_val = [&](uint32_t sender) {
+    Message m = make_msg(Flag::kGet, sender, 0);
+    model->Get(m);
+    Message r;
+    reply_queue.WaitAndPop(&r);
+    return third_party::SArray<int>(r.data[1])[0];
+  };
+
+  Message m = make_msg(Flag::kAdd, 2, 1);  // clock 0
+  model->Add(m);
+  m = make_msg(Flag::kClock, 2, 0);
+  model->Clock(m);
+  m = make_msg(Flag::kAdd, 2, 10);  // clock 1, worker 3 is still at clock 0
+  model->Add(m);
+  m = make_msg(Flag::kAdd, 3, 100);  // clock 0
+  model->Add(m);
+  EXPECT_EQ(dynamic_cast<BSPModel*>(model.get())->GetAddPendingSize(), 3);
+  EXPECT_EQ(get_val(3), 0);
+
+  m = make_msg(Flag::kClock, 3, 0);
+  model->Clock(m);
+  // only the adds of clock 0 are visible at clock 1
+  EXPECT_EQ(dynamic_cast<BSPModel*>(model.get())->GetAddPendingSize(), 1);
+  EXPECT_EQ(get_val(3), 101);
+
+  m = make_msg(Flag::kClock, 2, 0);
+  model->Clock(m);
+  m = make_msg(Flag::kClock, 3, 0);
+  model->Clock(m);
+  EXPECT_EQ(dynamic_cast<BSPModel*>(model.get())->GetAddPendingSize(), 0);
+  EXPECT_EQ(get_val(2), 111);
+}
+
+TEST_F(TestBSPModel, AddsOfGroupClock) {
+  ThreadsafeQueue<Message> reply_queue;
+  std::unique_ptr<AbstractStorage> storage(new MapStorage<int>(UpdateMode::Assign));
+  std::unique_ptr<AbstractModel> model(new BSPModel(0, std::move(storage), &reply_queue));
+  // workers 2 and 3 clock through group 50, worker 7 by itself
+  Message reset_msg;
+  reset_msg.AddData(third_party::SArray<uint32_t>({2, 3}));
+  reset_msg.AddData(third_party::SArray<uint32_t>({50}));
+  model->ResetWorker(reset_msg);
+  Message reset_msg2;
+  reset_msg2.AddData(third_party::SArray<uint32_t>({7}));
+  model->ResetWorker(reset_msg2);
+  Message reply;
+  reply_queue.WaitAndPop(&reply);
+  reply_queue.WaitAndPop(&reply);
+
+  auto make_msg = [](Flag flag, uint32_t sender, int clock, int val) {
+    Message m;
+    m.meta.flag = flag;
+    m.meta.sender = sender;
+    m.meta.clock = clock;
+    if (flag != Flag::kClock) m.AddData(third_party::SArray<Key>({1}));
+    if (flag == Flag::kAdd) m.AddData(third_party::SArray<int>({val}));
+    return m;
+  };
+  auto clock = [&](uint32_t sender) {
+    Message m = make_msg(Flag::kClock, sender, -1, 0);
+    model->Clock(m);
+  };
+  auto get_val = [&]() {
+    Message m = make_msg(Flag::kGet, 7, -1, 0);
+    model->Get(m);
+    Message r;
+    reply_queue.WaitAndPop(&r);
+    return third_party::SArray<int>(r.data[1])[0];
+  };
+
+  // worker 2 has clocked twice on its own, two clocks ahead of the min clock
+  Message m = make_msg(Flag::kAdd, 2, 0, 1);
+  model->Add(m);
+  m = make_msg(Flag::kAdd, 2, 2, 3);
+  model->Add(m);
+  clock(7);
+  m = make_msg(Flag::kAdd, 7, -1, 10);  // clock 1
+  model->Add(m);
+  EXPECT_EQ(dynamic_cast<BSPModel*>(model.get())->GetAddPendingSize(), 3);
+
+  // each barrier merges the Adds of its clock only, in the order of the clocks
+  clock(50);
+  EXPECT_EQ(get_val(), 1);
+  clock(50);
+  clock(7);
+  EXPECT_EQ(get_val(), 10);
+  EXPECT_EQ(dynamic_cast<BSPModel*>(model.get())->GetAddPendingSize(), 1);
+  clock(50);
+  clock(7);
+  EXPECT_EQ(get_val(), 3);
+  EXPECT_EQ(dynamic_cast<BSPModel*>(model.get())->GetAddPendingSize(), 0);
+}
+
+TEST_F(TestBSPModel, OptimizerSteps) {
+  ThreadsafeQueue<Message> reply_queue;
+  std::unique_ptr<VectorStorage<double>> storage(new VectorStorage<double>(third_party::Range(0, 10)));
+  OptimizerConfig config;
+  config.type = OptimizerType::Adagrad;
+  config.learning_rate = 1.0;
+  config.epsilon = 0;
+  storage->SetOptimizer(CreateOptimizer<double>(config));
+  std::unique_ptr<AbstractModel> model(new BSPModel(0, std::move(storage), &reply_queue));
+  Message reset_msg;
+  reset_msg.AddData(third_party::SArray<uint32_t>({2, 3}));
+  model->ResetWorker(reset_msg);
+  Message reply;
+  reply_queue.WaitAndPop(&reply);
+
+  // both workers send the gradient 3 in clock 0
+  for (uint32_t tid : {2, 3}) {
+    Message m;
+    m.meta.flag = Flag::kAdd;
+    m.meta.sender = tid;
+    m.AddData(third_party::SArray<Key>({4}));
+    m.AddData(third_party::SArray<double>({3.0}));
+    model->Add(m);
+  }
+  for (uint32_t tid : {2, 3}) {
+    Message m;
+    m.meta.flag = Flag::kClock;
+    m.meta.sender = tid;
+    model->Clock(m);
+  }
+
+  // the barrier takes one Adagrad step per Add, as AddBatch does, not one step on the summed gradient
+  Message get;
+  get.meta.flag = Flag::kGet;
+  get.meta.sender = 2;
+  get.AddData(third_party::SArray<Key>({4}));
+  model->Get(get);
+  reply_queue.WaitAndPop(&reply);
+  EXPECT_DOUBLE_EQ(third_party::SArray<double>(reply.data[1])[0], -1.0 - 3.0 / std::sqrt(18.0));
+}
+
 }  // namespace
 }  // namespace csci5570
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "gtest/gtest.h"
+
+#include "base/message.hpp"
+#include "base/threadsafe_queue.hpp"
+#include "server/abstract_model.hpp"
+
+#include <vector>
+
+namespace csci5570 {
+
+/**
+ * The messages the tests of the consistency models send to model 0 on server thread 0, with int values
+ */
+inline Message MakeMessage(Flag flag, int sender) {
+  Message m;
+  m.meta.flag = flag;
+  m.meta.model_id = 0;
+  m.meta.sender = sender;
+  m.meta.recver = 0;
+  return m;
+}
+
+inline Message MakeAdd(int sender, int key, int val) {
+  Message m = MakeMessage(Flag::kAdd, sender);
+  m.AddData(third_party::SArray<Key>({Key(key)}));
+  m.AddData(third_party::SArray<int>({val}));
+  return m;
+}
+
+inline Message MakeGet(int sender, int key) {
+  Message m = MakeMessage(Flag::kGet, sender);
+  m.AddData(third_party::SArray<Key>({Key(key)}));
+  return m;
+}
+
+/**
+ * Register the worker threads tids with a model and consume its reply
+ */
+inline void ResetWorkers(AbstractModel* model, const std::vector<uint32_t>& tids,
+                         ThreadsafeQueue<Message>* reply_queue) {
+  Message reset_msg;
+  reset_msg.AddData(third_party::SArray<uint32_t>(tids));
+  model->ResetWorker(reset_msg);
+  Message reset_reply_msg;
+  reply_queue->WaitAndPop(&reset_reply_msg);
+  EXPECT_EQ(reset_reply_msg.meta.flag, Flag::kResetWorkerInModel);
+}
+
+/**
+ * Pop the next reply, which must answer a Get of one key, and return its value
+ */
+inline int PopValue(ThreadsafeQueue<Message>* reply_queue) {
+  Message reply;
+  reply_queue->WaitAndPop(&reply);
+  EXPECT_EQ(reply.meta.flag, Flag::kGet);
+  return third_party::SArray<int>(reply.data[1])[0];
+}
+
+}  // namespace csci5570
@@ -5,45 +5,101 @@ namespace csci5570 {
 
 SSPModel::SSPModel(uint32_t model_id, std::unique_ptr<AbstractStorage>&& storage_ptr, int staleness,
                    ThreadsafeQueue<Message>* reply_queue): model_id_(model_id), storage_(std::move(storage_ptr)),
-                                                        staleness_(staleness), reply_queue_(reply_queue) {}
+                                                        staleness_(staleness), reply_queue_(reply_queue),
+                                                        buffer_(staleness + 1) {}
 void SSPModel::Clock(Message& msg) {
   if (!progress_tracker_.CheckThreadValid(msg.meta.sender)) return;
   int cur_mini_clock = progress_tracker_.AdvanceAndGetChangedMinClock(msg.meta.sender);
-  if (cur_mini_clock != -1 && GetPendingSize(cur_mini_clock) > 0) {// min_clock changed, process pending messages if needed
-    auto pendingMsgs = buffer_.Pop(cur_mini_clock);
-    for (auto pending : pendingMsgs) {
-      if (pending.meta.flag == Flag::kAdd) Add(pending);
-      if (pending.meta.flag == Flag::kGet) Get(pending);
+  if (cur_mini_clock == -1) return;
+  if (buffer_.Size() > 0) {// min_clock changed, release the gets waiting for it or any clock before
+    std::vector<Message> pending_msgs;
+    buffer_.PopUpTo(cur_mini_clock, &pending_msgs);
+    for (auto& pending : pending_msgs) Get(pending);
+  }
+  if (!subscriptions_.empty()) PushChangedKeys();
+  storage_->FinishIter();
+}
+
+// SSP only bounds how stale a read may be, reading newer updates is allowed,
+// so adds are applied in place instead of waiting for the slow workers
+void SSPModel::Add(Message& msg) {
+  if (!progress_tracker_.CheckThreadValid(msg.meta.sender)) return;
+  if (!subscriptions_.empty()) {
+    third_party::SArray<Key> keys(msg.data[0]);
+    changed_keys_.insert(keys.begin(), keys.end());
+  }
+  storage_->Add(msg);
+}
+
+void SSPModel::AddBatch(std::vector<Message>& msgs) {
+  std::vector<Message> valid_msgs;
+  valid_msgs.reserve(msgs.size());
+  for (auto& msg : msgs) {
+    if (!progress_tracker_.CheckThreadValid(msg.meta.sender)) continue;
+    if (!subscriptions_.empty()) {
+      third_party::SArray<Key> keys(msg.data[0]);
+      changed_keys_.insert(keys.begin(), keys.end());
     }
+    valid_msgs.push_back(msg);
   }
+  storage_->AddBatch(valid_msgs);
 }
 
 // suppose current clock 3, min clock 0, staleness 2
 // should wait for min clock 1 (3 - 2)
-void SSPModel::Add(Message& msg) {
+void SSPModel::Get(Message& msg) {
   if (!progress_tracker_.CheckThreadValid(msg.meta.sender)) return;
-  auto cur_clock = GetProgress(msg.meta.sender);
+  auto cur_clock = SenderClock(msg);
   if (cur_clock - progress_tracker_.GetMinClock() <= staleness_) {
-    storage_->Add(msg);
+    Message reply = storage_->Get(msg);
+    // the reply may be cached by the worker until its clock passes the bound
+    reply.meta.clock = progress_tracker_.GetMinClock() + staleness_;
+    reply_queue_->Push(std::move(reply));
   } else {
-    buffer_.Push(cur_clock - staleness_, msg);
+    buffer_.Push(cur_clock - staleness_, std::move(msg));
   }
 }
 
-void SSPModel::Get(Message& msg) {
+void SSPModel::Subscribe(Message& msg) {
   if (!progress_tracker_.CheckThreadValid(msg.meta.sender)) return;
-  auto cur_clock = GetProgress(msg.meta.sender);
-  if (cur_clock - progress_tracker_.GetMinClock() <= staleness_) {
-    reply_queue_->Push(storage_->Get(msg));
-  } else {
-    buffer_.Push(cur_clock - staleness_, msg);
+  server_id_ = msg.meta.recver;
+  third_party::SArray<Key> keys(msg.data[0]);
+  subscriptions_[msg.meta.sender] = keys;
+  Push(msg.meta.sender, keys);
+}
+
+void SSPModel::Push(int tid, const third_party::SArray<Key>& keys) {
+  Message request;
+  request.meta.sender = tid;
+  request.meta.recver = server_id_;
+  request.meta.model_id = model_id_;
+  request.AddData(keys);
+  Message push = storage_->Get(request);
+  push.meta.flag = Flag::kPush;
+  push.meta.clock = progress_tracker_.GetMinClock() + staleness_;
+  reply_queue_->Push(std::move(push));
+}
+
+void SSPModel::PushChangedKeys() {
+  for (auto& subscription : subscriptions_) {
+    // an empty push still moves the clock the worker may read its values at
+    third_party::SArray<Key> changed;
+    for (auto key : subscription.second) {
+      if (changed_keys_.count(key)) changed.push_back(key);
+    }
+    Push(subscription.first, changed);
   }
+  changed_keys_.clear();
 }
 
 int SSPModel::GetProgress(int tid) {
   return progress_tracker_.GetProgress(tid);
 }
 
+int SSPModel::SenderClock(const Message& msg) {
+  return msg.meta.clock >= 0 ? msg.meta.clock : GetProgress(msg.meta.sender);
+}
+
 int SSPModel::GetPendingSize(int progress) {
   return buffer_.Size(progress);
 }
@@ -51,7 +107,13 @@ int SSPModel::GetPendingSize(int progress) {
 void SSPModel::ResetWorker(Message& msg) {
   // convert char[] to uint32_t !!!!!!
   third_party::SArray<uint32_t> tids(msg.data[0]);
-  progress_tracker_.Init(std::vector<uint32_t>(tids.begin(), tids.end()));
+  if (msg.data.size() > 1) {
+    // the workers clock as a group, through the clock aggregator of their node
+    third_party::SArray<uint32_t> group(msg.data[1]);
+    progress_tracker_.InitGroup(group[0], std::vector<uint32_t>(tids.begin(), tids.end()));
+  } else {
+    progress_tracker_.Init(std::vector<uint32_t>(tids.begin(), tids.end()));
+  }
   Message relpy;
   relpy.meta.flag = Flag::kResetWorkerInModel;
   relpy.meta.model_id = msg.meta.model_id;
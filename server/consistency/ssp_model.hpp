@@ -1,3 +1,5 @@
+#pragma once
+
 #include "server/abstract_model.hpp"
 
 #include "base/message.hpp"
@@ -7,12 +9,17 @@
 #include "server/util/progress_tracker.hpp"
 
 #include <map>
+#include <unordered_set>
 #include <vector>
 
 namespace csci5570 {
 
 /**
  * A wrapper for model with Stale Synchronous Parallel consistency
+ *
+ * Workers may subscribe to keys (Eager SSP). The subscribed keys are pushed to a worker once when it subscribes, and
+ * then every time the min clock advances, the ones changed since the last advance. Each push tells the worker up
+ * to which of its clocks the values may be read, so its next Gets are served from the pushed values.
  */
 class SSPModel : public AbstractModel {
  public:
@@ -22,8 +29,10 @@ class SSPModel : public AbstractModel {
   virtual void Clock(Message& msg) override;
   virtual void Add(Message& msg) override;
   virtual void Get(Message& msg) override;
+  virtual void AddBatch(std::vector<Message>& msgs) override;
   virtual int GetProgress(int tid) override;
   virtual void ResetWorker(Message& msg) override;
+  virtual void Subscribe(Message& msg) override;
 
   /**
    * Return the number of requests waiting at the specific progress
@@ -32,14 +41,24 @@ class SSPModel : public AbstractModel {
    */
   int GetPendingSize(int progress);
 
- private:
+ protected:
+  // the clock of the worker sending an Add or Get, carried by the message when its node aggregates clocks
+  int SenderClock(const Message& msg);
+  // push the values of keys to a subscriber, readable up to the clock min clock + staleness
+  void Push(int tid, const third_party::SArray<Key>& keys);
+  void PushChangedKeys();
+
   uint32_t model_id_;
-  uint32_t staleness_;
+  int staleness_;
 
   ThreadsafeQueue<Message>* reply_queue_;
   std::unique_ptr<AbstractStorage> storage_;
   ProgressTracker progress_tracker_;
   PendingBuffer buffer_;
+
+  std::map<int, third_party::SArray<Key>> subscriptions_;  // tid -> the keys of this shard it subscribed to
+  std::unordered_set<Key> changed_keys_;  // the keys added to since the last min clock advance, if subscribed to
+  int server_id_ = -1;                    // the server thread the subscriptions arrived at
 };
 
 }  // namespace csci5570
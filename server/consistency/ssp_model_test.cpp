@@ -102,6 +102,7 @@ TEST_F(TestSSPModel, CheckGetAndAdd) {
   EXPECT_EQ(rep_vals[0], 1);
   EXPECT_EQ(check_msg.meta.sender, 0);
   EXPECT_EQ(check_msg.meta.recver, 2);
+  EXPECT_EQ(check_msg.meta.clock, 1);  // min clock 0 + staleness 1
 
   reply_queue.WaitAndPop(&check_msg);
   ASSERT_EQ(check_msg.data.size(), 2);
@@ -249,5 +250,121 @@ TEST_F(TestSSPModel, CheckStaleness) {
   EXPECT_EQ(dynamic_cast<SSPModel*>(model.get())->GetPendingSize(1), 0);
 }
 
+TEST_F(TestSSPModel, GroupClock) {
+  ThreadsafeQueue<Message> reply_queue;
+  std::unique_ptr<AbstractStorage> storage(new MapStorage<int>());
+  std::unique_ptr<AbstractModel> model(new SSPModel(0, std::move(storage), 1, &reply_queue));
+  // workers 2 and 3 clock through group 50, worker 7 by itself
+  Message reset_msg;
+  reset_msg.AddData(third_party::SArray<uint32_t>({2, 3}));
+  reset_msg.AddData(third_party::SArray<uint32_t>({50}));
+  model->ResetWorker(reset_msg);
+  Message reset_msg2;
+  reset_msg2.AddData(third_party::SArray<uint32_t>({7}));
+  model->ResetWorker(reset_msg2);
+  Message reply;
+  reply_queue.WaitAndPop(&reply);
+  reply_queue.WaitAndPop(&reply);
+
+  Message clock_msg;
+  clock_msg.meta.flag = Flag::kClock;
+  clock_msg.meta.sender = 50;
+  model->Clock(clock_msg);
+  clock_msg.meta.sender = 7;
+  model->Clock(clock_msg);  // min clock 1
+  EXPECT_EQ(model->GetProgress(3), 1);
+
+  // worker 2 has clocked 3 times on its own, its Get carries its clock and waits for min clock 2
+  Message get_msg;
+  get_msg.meta.flag = Flag::kGet;
+  get_msg.meta.sender = 2;
+  get_msg.meta.clock = 3;
+  get_msg.AddData(third_party::SArray<Key>({0}));
+  model->Get(get_msg);
+  EXPECT_EQ(dynamic_cast<SSPModel*>(model.get())->GetPendingSize(2), 1);
+  EXPECT_EQ(reply_queue.Size(), 0);
+
+  clock_msg.meta.sender = 50;
+  model->Clock(clock_msg);
+  clock_msg.meta.sender = 7;
+  model->Clock(clock_msg);  // min clock 2
+  reply_queue.WaitAndPop(&reply);
+  EXPECT_EQ(reply.meta.recver, 2);
+}
+
+TEST_F(TestSSPModel, CheckSubscribe) {
+  ThreadsafeQueue<Message> reply_queue;
+  int staleness = 1;
+  int model_id = 0;
+  std::unique_ptr<AbstractStorage> storage(new MapStorage<int>());
+  std::unique_ptr<AbstractModel> model(new SSPModel(model_id, std::move(storage), staleness, &reply_queue));
+  Message reset_msg;
+  third_party::SArray<uint32_t> tids({2, 3});
+  reset_msg.AddData(tids);
+  model->ResetWorker(reset_msg);
+  Message reset_reply_msg;
+  reply_queue.WaitAndPop(&reset_reply_msg);
+
+  // worker 2 subscribes to keys 0 and 1, worker 3 to key 2
+  Message s2;
+  s2.meta.flag = Flag::kSubscribe;
+  s2.meta.model_id = 0;
+  s2.meta.sender = 2;
+  s2.meta.recver = 0;
+  s2.AddData(third_party::SArray<int>({0, 1}));
+  model->Subscribe(s2);
+  Message s3 = s2;
+  s3.meta.sender = 3;
+  s3.data.clear();
+  s3.AddData(third_party::SArray<int>({2}));
+  model->Subscribe(s3);
+
+  // the subscribed keys are pushed at once, readable until clock staleness
+  ASSERT_EQ(reply_queue.Size(), 2);
+  Message push;
+  reply_queue.WaitAndPop(&push);
+  EXPECT_EQ(push.meta.flag, Flag::kPush);
+  EXPECT_EQ(push.meta.sender, 0);
+  EXPECT_EQ(push.meta.recver, 2);
+  EXPECT_EQ(push.meta.clock, 1);
+  EXPECT_EQ(third_party::SArray<int>(push.data[0]).size(), 2);
+  reply_queue.WaitAndPop(&push);
+  EXPECT_EQ(push.meta.recver, 3);
+
+  Message add;
+  add.meta.flag = Flag::kAdd;
+  add.meta.model_id = 0;
+  add.meta.sender = 3;
+  add.meta.recver = 0;
+  add.AddData(third_party::SArray<int>({1}));
+  add.AddData(third_party::SArray<int>({5}));
+  model->Add(add);
+
+  Message clock;
+  clock.meta.flag = Flag::kClock;
+  clock.meta.model_id = 0;
+  clock.meta.recver = 0;
+  clock.meta.sender = 2;
+  model->Clock(clock);
+  EXPECT_EQ(reply_queue.Size(), 0);
+  clock.meta.sender = 3;
+  model->Clock(clock);
+
+  // the min clock advanced, each subscriber gets the keys changed since
+  ASSERT_EQ(reply_queue.Size(), 2);
+  reply_queue.WaitAndPop(&push);
+  EXPECT_EQ(push.meta.recver, 2);
+  EXPECT_EQ(push.meta.clock, 2);
+  auto keys = third_party::SArray<int>(push.data[0]);
+  auto vals = third_party::SArray<int>(push.data[1]);
+  ASSERT_EQ(keys.size(), 1);
+  EXPECT_EQ(keys[0], 1);
+  EXPECT_EQ(vals[0], 5);
+  reply_queue.WaitAndPop(&push);
+  EXPECT_EQ(push.meta.recver, 3);
+  EXPECT_EQ(push.meta.clock, 2);
+  EXPECT_EQ(third_party::SArray<int>(push.data[0]).size(), 0);
+}
+
 }  // namespace
 }  // namespace csci5570
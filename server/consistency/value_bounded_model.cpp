@@ -0,0 +1,99 @@
+#include "server/consistency/value_bounded_model.hpp"
+#include "glog/logging.h"
+
+namespace csci5570 {
+
+ValueBoundedModel::ValueBoundedModel(uint32_t model_id, std::unique_ptr<AbstractStorage>&& storage_ptr,
+                                     const ValueBoundConfig& config, ThreadsafeQueue<Message>* reply_queue)
+    : model_id_(model_id), config_(config), reply_queue_(reply_queue), storage_(std::move(storage_ptr)) {
+  CHECK_GE(config_.max_pending_updates, 0);
+  CHECK_GE(config_.max_staleness, 0);
+}
+
+void ValueBoundedModel::Clock(Message& msg) {
+  if (!progress_tracker_.CheckThreadValid(msg.meta.sender)) return;
+  int cur_mini_clock = progress_tracker_.AdvanceAndGetChangedMinClock(msg.meta.sender);
+  if (cur_mini_clock == -1) return;
+  // merge the clock every worker finished, the storage is now the version of the min clock
+  auto it = held_clocks_.find(cur_mini_clock - 1);
+  if (it != held_clocks_.end()) {
+    storage_->MergeDelta(*it->second.delta);
+    held_clocks_.erase(it);
+  }
+  std::vector<Message> still_pending;
+  for (auto& pending : get_buffer_) {
+    if (CanServe(pending)) {
+      reply_queue_->Push(storage_->Get(pending));
+    } else {
+      still_pending.push_back(std::move(pending));
+    }
+  }
+  get_buffer_.swap(still_pending);
+  storage_->FinishIter();
+}
+
+void ValueBoundedModel::Add(Message& msg) {
+  if (!progress_tracker_.CheckThreadValid(msg.meta.sender)) return;
+  auto& held = held_clocks_[SenderClock(msg)];
+  if (!held.delta) held.delta = storage_->CreateDelta();
+  held.delta->Add(msg);
+  third_party::SArray<Key> keys(msg.data[0]);
+  for (auto key : keys) ++held.num_updates[key];
+}
+
+void ValueBoundedModel::Get(Message& msg) {
+  if (!progress_tracker_.CheckThreadValid(msg.meta.sender)) return;
+  if (CanServe(msg)) {
+    reply_queue_->Push(storage_->Get(msg));
+  } else {
+    get_buffer_.push_back(msg);
+  }
+}
+
+bool ValueBoundedModel::CanServe(const Message& msg) {
+  int clock = SenderClock(msg);
+  int min_clock = progress_tracker_.GetMinClock();
+  if (clock <= min_clock) return true;
+  if (clock - min_clock > config_.max_staleness) return false;
+  third_party::SArray<Key> keys(msg.data[0]);
+  for (auto key : keys) {
+    if (GetPendingUpdates(key, clock) > config_.max_pending_updates) return false;
+  }
+  return true;
+}
+
+int ValueBoundedModel::GetPendingUpdates(Key key, int clock) const {
+  int num_updates = 0;
+  for (auto it = held_clocks_.begin(); it != held_clocks_.end() && it->first < clock; ++it) {
+    auto count = it->second.num_updates.find(key);
+    if (count != it->second.num_updates.end()) num_updates += count->second;
+  }
+  return num_updates;
+}
+
+int ValueBoundedModel::GetProgress(int tid) {
+  return progress_tracker_.GetProgress(tid);
+}
+
+int ValueBoundedModel::SenderClock(const Message& msg) {
+  return msg.meta.clock >= 0 ? msg.meta.clock : GetProgress(msg.meta.sender);
+}
+
+void ValueBoundedModel::ResetWorker(Message& msg) {
+  third_party::SArray<uint32_t> tids(msg.data[0]);
+  if (msg.data.size() > 1) {
+    // the workers clock as a group, through the clock aggregator of their node
+    third_party::SArray<uint32_t> group(msg.data[1]);
+    progress_tracker_.InitGroup(group[0], std::vector<uint32_t>(tids.begin(), tids.end()));
+  } else {
+    progress_tracker_.Init(std::vector<uint32_t>(tids.begin(), tids.end()));
+  }
+  Message reply;
+  reply.meta.flag = Flag::kResetWorkerInModel;
+  reply.meta.model_id = msg.meta.model_id;
+  reply.meta.recver = msg.meta.sender;
+  reply.meta.sender = msg.meta.recver;
+  reply_queue_->Push(reply);
+}
+
+}  // namespace csci5570
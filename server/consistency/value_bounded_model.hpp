@@ -0,0 +1,70 @@
+#pragma once
+
+#include "server/abstract_model.hpp"
+
+#include "base/message.hpp"
+#include "base/threadsafe_queue.hpp"
+#include "server/abstract_storage.hpp"
+#include "server/util/progress_tracker.hpp"
+
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace csci5570 {
+
+/**
+ * The bounds of ValueBoundedModel
+ */
+struct ValueBoundConfig {
+  int max_pending_updates = 0;  // the Adds a Get may miss per key, among those the servers hold
+  int max_staleness = 4;        // how many clocks a worker may run ahead of the min clock regardless
+};
+
+/**
+ * A model whose Gets wait on the keys they read instead of the whole table
+ *
+ * As in BSP, the Adds of a clock are held and merged into the storage when the min clock passes it, so the
+ * storage holds the version of the min clock. A worker at clock c should read the Adds of all clocks before c.
+ * Its Get is served from the storage if, for every key it reads, the held Adds of clocks before c are at most
+ * max_pending_updates, and otherwise waits for the min clock to move. Keys that no worker touched in the
+ * clocks in flight are thus read without waiting for the slowest worker, up to max_staleness clocks ahead.
+ */
+class ValueBoundedModel : public AbstractModel {
+ public:
+  ValueBoundedModel(uint32_t model_id, std::unique_ptr<AbstractStorage>&& storage_ptr,
+                    const ValueBoundConfig& config, ThreadsafeQueue<Message>* reply_queue);
+
+  virtual void Clock(Message& msg) override;
+  virtual void Add(Message& msg) override;
+  virtual void Get(Message& msg) override;
+  virtual int GetProgress(int tid) override;
+  virtual void ResetWorker(Message& msg) override;
+
+  int GetGetPendingSize() const { return get_buffer_.size(); }
+  // the number of held Adds to key from clocks before <clock>
+  int GetPendingUpdates(Key key, int clock) const;
+
+ private:
+  // the Adds of one clock, not merged yet
+  struct HeldClock {
+    std::unique_ptr<AbstractStorage> delta;
+    std::unordered_map<Key, int> num_updates;  // key -> the number of Adds to it
+  };
+
+  // the clock of the worker sending an Add or Get, carried by the message when its node aggregates clocks
+  int SenderClock(const Message& msg);
+  bool CanServe(const Message& msg);
+
+  uint32_t model_id_;
+  ValueBoundConfig config_;
+
+  ThreadsafeQueue<Message>* reply_queue_;
+  std::unique_ptr<AbstractStorage> storage_;
+  ProgressTracker progress_tracker_;
+  std::map<int, HeldClock> held_clocks_;  // clock -> its Adds, for the clocks from the min clock up
+  std::vector<Message> get_buffer_;       // the Gets waiting for the min clock to move
+};
+
+}  // namespace csci5570
@@ -0,0 +1,95 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "base/threadsafe_queue.hpp"
+#include "server/consistency/model_test_util.hpp"
+#include "server/consistency/value_bounded_model.hpp"
+#include "server/map_storage.hpp"
+
+namespace csci5570 {
+namespace {
+
+class TestValueBoundedModel : public testing::Test {
+ public:
+  TestValueBoundedModel() {}
+  ~TestValueBoundedModel() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+std::unique_ptr<ValueBoundedModel> CreateModel(const ValueBoundConfig& config, ThreadsafeQueue<Message>* reply_queue) {
+  std::unique_ptr<AbstractStorage> storage(new MapStorage<int>(UpdateMode::Accumulate));
+  std::unique_ptr<ValueBoundedModel> model(new ValueBoundedModel(0, std::move(storage), config, reply_queue));
+  ResetWorkers(model.get(), {2, 3}, reply_queue);
+  return model;
+}
+
+TEST_F(TestValueBoundedModel, WaitOnlyForUpdatedKeys) {
+  ThreadsafeQueue<Message> reply_queue;
+  auto model = CreateModel(ValueBoundConfig(), &reply_queue);
+
+  // worker 2 updates key 0 in clock 0 and moves on, worker 3 is still in clock 0
+  auto add = MakeAdd(2, 0, 1);
+  model->Add(add);
+  auto clock = MakeMessage(Flag::kClock, 2);
+  model->Clock(clock);
+  EXPECT_EQ(model->GetPendingUpdates(0, 1), 1);
+
+  // key 1 was not updated, so worker 2 reads it at clock 1 without waiting for worker 3
+  auto get = MakeGet(2, 1);
+  model->Get(get);
+  EXPECT_EQ(PopValue(&reply_queue), 0);
+  get = MakeGet(2, 0);
+  model->Get(get);
+  EXPECT_EQ(model->GetGetPendingSize(), 1);
+
+  // a Get at the min clock reads the version of the min clock
+  get = MakeGet(3, 0);
+  model->Get(get);
+  EXPECT_EQ(PopValue(&reply_queue), 0);
+
+  clock = MakeMessage(Flag::kClock, 3);
+  model->Clock(clock);
+  EXPECT_EQ(model->GetGetPendingSize(), 0);
+  EXPECT_EQ(model->GetPendingUpdates(0, 1), 0);
+  EXPECT_EQ(PopValue(&reply_queue), 1);
+}
+
+TEST_F(TestValueBoundedModel, Bounds) {
+  ThreadsafeQueue<Message> reply_queue;
+  ValueBoundConfig config;
+  config.max_pending_updates = 1;
+  config.max_staleness = 2;
+  auto model = CreateModel(config, &reply_queue);
+
+  // one held Add to key 0 is within the bound
+  auto add = MakeAdd(2, 0, 1);
+  model->Add(add);
+  auto clock = MakeMessage(Flag::kClock, 2);
+  model->Clock(clock);
+  auto get = MakeGet(2, 0);
+  model->Get(get);
+  EXPECT_EQ(PopValue(&reply_queue), 0);
+
+  // two are not
+  add = MakeAdd(2, 0, 1);
+  model->Add(add);
+  clock = MakeMessage(Flag::kClock, 2);
+  model->Clock(clock);
+  get = MakeGet(2, 0);
+  model->Get(get);
+  EXPECT_EQ(model->GetGetPendingSize(), 1);
+
+  // and an untouched key still waits once the worker is more than max_staleness ahead
+  clock = MakeMessage(Flag::kClock, 2);
+  model->Clock(clock);
+  get = MakeGet(2, 1);
+  model->Get(get);
+  EXPECT_EQ(model->GetGetPendingSize(), 2);
+  EXPECT_EQ(reply_queue.Size(), 0);
+}
+
+}  // namespace
+}  // namespace csci5570
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "base/message.hpp"
+#include "server/abstract_storage.hpp"
+#include "server/add_log_storage.hpp"
+#include "server/optimizer/abstract_optimizer.hpp"
+#include "server/util/initializer.hpp"
+#include "server/util/update_kernels.hpp"
+
+#include "glog/logging.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace csci5570 {
+
+/**
+ * Open-addressing hash storage for sparse models
+ *
+ * Robin hood linear probing over power-of-two tables. Keys, values, probe distances and optimizer states
+ * live in separate arrays so that a probe sequence only touches the keys and distances.
+ * Each key maps to a row of row_width values stored contiguously at vals_[slot * row_width].
+ */
+template <typename Val>
+class HashStorage : public AbstractStorage {
+ public:
+  /**
+   * @param size_hint   the expected number of keys, used to reserve the table up front
+   * @param mode        whether an Add overwrites or accumulates into the stored value
+   * @param row_width   the number of values per key
+   */
+  explicit HashStorage(size_t size_hint = 0, UpdateMode mode = UpdateMode::Assign, size_t row_width = 1)
+      : mode_(mode), row_width_(row_width) {
+    CHECK_GT(row_width_, 0);
+    Reserve(size_hint);
+  }
+
+  virtual void SubAdd(const third_party::SArray<Key>& typed_keys,
+      const third_party::SArray<char>& vals) override {
+    auto typed_vals = third_party::SArray<Val>(vals);
+    CHECK_EQ(typed_keys.size() * row_width_, typed_vals.size());
+
+    if (optimizer_) {
+      ApplyOptimizer(typed_keys, typed_vals);
+      return;
+    }
+    Apply(mode_, typed_keys, typed_vals);
+  }
+
+  virtual void SubAssign(const third_party::SArray<Key>& typed_keys,
+      const third_party::SArray<char>& vals) override {
+    auto typed_vals = third_party::SArray<Val>(vals);
+    CHECK_EQ(typed_keys.size() * row_width_, typed_vals.size());
+    Apply(UpdateMode::Assign, typed_keys, typed_vals);
+  }
+
+  virtual third_party::SArray<char> SubGet(const third_party::SArray<Key>& typed_keys) override {
+    third_party::SArray<Val> reply_vals(typed_keys.size() * row_width_);
+    for (int i = 0; i < typed_keys.size(); ++i) {
+      auto slot = Find(typed_keys[i]);
+      auto* dst = reply_vals.data() + i * row_width_;
+      if (slot == kNotFound) {
+        initializer_.Fill(typed_keys[i], dst, row_width_);
+      } else {
+        memcpy(dst, Row(slot), row_width_ * sizeof(Val));
+      }
+    }
+    return third_party::SArray<char>(reply_vals);
+  }
+
+  virtual std::unique_ptr<AbstractStorage> CreateDelta() const override {
+    if (optimizer_) return std::unique_ptr<AbstractStorage>(new AddLogStorage());
+    return std::unique_ptr<AbstractStorage>(new HashStorage<Val>(0, mode_, row_width_));
+  }
+
+  virtual void SubDump(third_party::SArray<Key>* typed_keys, third_party::SArray<char>* vals) const override {
+    third_party::SArray<Key> keys(size_);
+    third_party::SArray<Val> typed_vals(size_ * row_width_);
+    size_t n = 0;
+    for (size_t slot = 0; slot < keys_.size(); ++slot) {
+      if (dists_[slot] == 0) continue;
+      keys[n] = keys_[slot];
+      CopyRow(typed_vals.data(), n, vals_.data(), slot);
+      ++n;
+    }
+    *typed_keys = keys;
+    *vals = third_party::SArray<char>(typed_vals);
+  }
+
+  virtual void FinishIter() override {}
+
+  /**
+   * Treat the values of Add as gradients of an optimizer, whose states are kept next to the values
+   */
+  void SetOptimizer(std::unique_ptr<AbstractOptimizer<Val>>&& optimizer) {
+    optimizer_ = std::move(optimizer);
+    states_.assign(optimizer_ ? optimizer_->GetNumStates() : 0, std::vector<Val>(vals_.size()));
+  }
+
+  /**
+   * Set the values of keys that have not been added to, reads of such keys still do not insert them
+   */
+  void SetInitializer(const Initializer& initializer) { initializer_ = initializer; }
+
+  /**
+   * Make room for at least n keys without rehashing
+   */
+  void Reserve(size_t n) {
+    size_t capacity = kMinCapacity;
+    while (capacity * kMaxLoadNum < n * kMaxLoadDen) capacity <<= 1;
+    if (capacity > keys_.size()) Rehash(capacity);
+  }
+
+  size_t Size() const { return size_; }
+  size_t Capacity() const { return keys_.size(); }
+
+ private:
+  static const size_t kNotFound = static_cast<size_t>(-1);
+  static const size_t kMinCapacity = 16;
+  // grow when the load factor exceeds kMaxLoadNum / kMaxLoadDen
+  static const size_t kMaxLoadNum = 3;
+  static const size_t kMaxLoadDen = 4;
+
+  // murmur3 finalizer, spreads consecutive keys over the table
+  static uint32_t Hash(Key key) {
+    key ^= key >> 16;
+    key *= 0x85ebca6b;
+    key ^= key >> 13;
+    key *= 0xc2b2ae35;
+    key ^= key >> 16;
+    return key;
+  }
+
+  void Apply(UpdateMode mode, const third_party::SArray<Key>& typed_keys, const third_party::SArray<Val>& typed_vals) {
+    for (int i = 0; i < typed_keys.size(); ++i) {
+      ApplyRun(mode, Row(FindOrInsert(typed_keys[i])), typed_vals.data() + i * row_width_, row_width_);
+    }
+  }
+
+  void ApplyOptimizer(const third_party::SArray<Key>& typed_keys, const third_party::SArray<Val>& typed_vals) {
+    // inserting may move other entries, so insert all missing keys before collecting the slots
+    std::vector<size_t> slots(typed_keys.size());
+    bool inserted = false;
+    for (int i = 0; i < typed_keys.size(); ++i) {
+      slots[i] = Find(typed_keys[i]);
+      if (slots[i] == kNotFound) {
+        FindOrInsert(typed_keys[i]);
+        inserted = true;
+      }
+    }
+    if (inserted) {
+      for (int i = 0; i < typed_keys.size(); ++i) slots[i] = Find(typed_keys[i]);
+    }
+    // the optimizers work on individual values, so expand the slots of rows
+    if (row_width_ > 1) {
+      std::vector<size_t> row_slots(slots.size() * row_width_);
+      for (size_t i = 0; i < row_slots.size(); ++i) row_slots[i] = slots[i / row_width_] * row_width_ + i % row_width_;
+      slots.swap(row_slots);
+    }
+    std::vector<Val*> states(states_.size());
+    for (int i = 0; i < states_.size(); ++i) states[i] = states_[i].data();
+    optimizer_->Update(slots.data(), typed_vals.data(), slots.size(), vals_.data(), states.data());
+  }
+
+  size_t Find(Key key) const {
+    size_t mask = keys_.size() - 1;
+    size_t slot = Hash(key) & mask;
+    // dists_[slot] is 0 for an empty slot and (probe distance + 1) otherwise
+    for (uint32_t dist = 1; dists_[slot] >= dist; ++dist) {
+      if (keys_[slot] == key) return slot;
+      slot = (slot + 1) & mask;
+    }
+    return kNotFound;
+  }
+
+  size_t FindOrInsert(Key key) {
+    auto slot = Find(key);
+    if (slot != kNotFound) return slot;
+    if ((size_ + 1) * kMaxLoadDen > keys_.size() * kMaxLoadNum) Rehash(keys_.size() << 1);
+    slot = Insert(key);
+    initializer_.Fill(key, Row(slot), row_width_);
+    for (auto& state : states_) std::fill(&state[slot * row_width_], &state[(slot + 1) * row_width_], Val());
+    return slot;
+  }
+
+  // insert a key known to be absent and return its slot, the caller sets the value and states of the slot
+  size_t Insert(Key key) {
+    size_t mask = keys_.size() - 1;
+    size_t slot = Hash(key) & mask;
+    uint32_t dist = 1;
+    // robin hood: take the first slot whose entry is closer to its home than the new key
+    while (dists_[slot] >= dist) {
+      slot = (slot + 1) & mask;
+      ++dist;
+    }
+    // shift the following cluster by one to make room
+    size_t empty = slot;
+    while (dists_[empty] != 0) empty = (empty + 1) & mask;
+    for (size_t to = empty; to != slot;) {
+      size_t from = (to - 1) & mask;
+      keys_[to] = keys_[from];
+      dists_[to] = dists_[from] + 1;
+      CopyRow(vals_.data(), to, vals_.data(), from);
+      for (auto& state : states_) CopyRow(state.data(), to, state.data(), from);
+      to = from;
+    }
+    keys_[slot] = key;
+    dists_[slot] = dist;
+    ++size_;
+    return slot;
+  }
+
+  void Rehash(size_t capacity) {
+    std::vector<Key> old_keys(capacity);
+    std::vector<Val> old_vals(capacity * row_width_);
+    std::vector<uint32_t> old_dists(capacity, 0);
+    std::vector<std::vector<Val>> old_states(states_.size(), std::vector<Val>(capacity * row_width_));
+    old_keys.swap(keys_);
+    old_vals.swap(vals_);
+    old_dists.swap(dists_);
+    old_states.swap(states_);
+    size_ = 0;
+    for (size_t i = 0; i < old_keys.size(); ++i) {
+      if (old_dists[i] == 0) continue;
+      auto slot = Insert(old_keys[i]);
+      CopyRow(vals_.data(), slot, old_vals.data(), i);
+      for (int j = 0; j < states_.size(); ++j) CopyRow(states_[j].data(), slot, old_states[j].data(), i);
+    }
+  }
+
+  Val* Row(size_t slot) { return vals_.data() + slot * row_width_; }
+
+  void CopyRow(Val* dst, size_t to, const Val* src, size_t from) const {
+    memcpy(dst + to * row_width_, src + from * row_width_, row_width_ * sizeof(Val));
+  }
+
+  UpdateMode mode_;
+  size_t row_width_;
+  Initializer initializer_;
+  std::unique_ptr<AbstractOptimizer<Val>> optimizer_;  // Adds are gradients when set
+  std::vector<Key> keys_;
+  std::vector<Val> vals_;
+  std::vector<uint32_t> dists_;
+  std::vector<std::vector<Val>> states_;  // optimizer states, parallel to vals_
+  size_t size_ = 0;
+};
+
+}  // namespace csci5570
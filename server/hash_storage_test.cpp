@@ -0,0 +1,205 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/hash_storage.hpp"
+#include "server/optimizer/optimizers.hpp"
+
+namespace csci5570 {
+namespace {
+
+class TestHashStorage : public testing::Test {
+ public:
+  TestHashStorage() {}
+  ~TestHashStorage() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+TEST_F(TestHashStorage, AddGetInt) {
+  HashStorage<int> s;
+
+  Message m;
+  third_party::SArray<Key> s_keys({13, 14, 15});
+  third_party::SArray<int> s_vals({1, 2, 3});
+  m.AddData(s_keys);
+  m.AddData(s_vals);
+  s.Add(m);
+
+  Message m2;
+  m2.AddData(s_keys);
+  Message rep = s.Get(m2);
+
+  EXPECT_EQ(rep.data.size(), 2);
+  auto rep_keys = third_party::SArray<Key>(rep.data[0]);
+  auto rep_vals = third_party::SArray<int>(rep.data[1]);
+  for (int index = 0; index < s_keys.size(); index++) {
+    EXPECT_EQ(rep_keys[index], s_keys[index]);
+    EXPECT_EQ(rep_vals[index], s_vals[index]);
+  }
+}
+
+TEST_F(TestHashStorage, GetMissingKey) {
+  HashStorage<float> s;
+  third_party::SArray<Key> s_keys({7});
+  third_party::SArray<float> ret = third_party::SArray<float>(s.SubGet(s_keys));
+  ASSERT_EQ(ret.size(), 1);
+  EXPECT_EQ(ret[0], 0);
+  EXPECT_EQ(s.Size(), 0);  // reads do not insert
+}
+
+TEST_F(TestHashStorage, Reserve) {
+  HashStorage<double> s(1000);
+  auto capacity = s.Capacity();
+  EXPECT_GE(capacity * 3, 1000 * 4);
+  EXPECT_EQ(capacity & (capacity - 1), 0);  // power of two
+
+  third_party::SArray<Key> s_keys(1000);
+  third_party::SArray<double> s_vals(1000);
+  for (int i = 0; i < 1000; ++i) {
+    s_keys[i] = i * 7919;
+    s_vals[i] = i * 0.5;
+  }
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+  EXPECT_EQ(s.Size(), 1000);
+  EXPECT_EQ(s.Capacity(), capacity);  // no rehash within the hint
+}
+
+TEST_F(TestHashStorage, GrowAndOverwrite) {
+  HashStorage<int> s;
+  const int n = 10000;
+  third_party::SArray<Key> s_keys(n);
+  third_party::SArray<int> s_vals(n);
+  for (int i = 0; i < n; ++i) {
+    s_keys[i] = i * 31;
+    s_vals[i] = i;
+  }
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+  for (int i = 0; i < n; ++i) s_vals[i] = -i;
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+  EXPECT_EQ(s.Size(), n);
+
+  third_party::SArray<int> ret = third_party::SArray<int>(s.SubGet(s_keys));
+  ASSERT_EQ(ret.size(), n);
+  for (int i = 0; i < n; ++i) {
+    EXPECT_EQ(ret[i], -i);
+  }
+}
+
+TEST_F(TestHashStorage, Accumulate) {
+  HashStorage<int> s(0, UpdateMode::Accumulate);
+
+  third_party::SArray<Key> s_keys({13, 14, 13});
+  third_party::SArray<int> s_vals({1, 2, 3});
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+  third_party::SArray<int> ret = third_party::SArray<int>(s.SubGet(third_party::SArray<Key>({13, 14})));
+  EXPECT_EQ(ret[0], 8);
+  EXPECT_EQ(ret[1], 4);
+}
+
+TEST_F(TestHashStorage, Optimizer) {
+  HashStorage<double> s;
+  OptimizerConfig config;
+  config.type = OptimizerType::SGD;
+  config.learning_rate = 0.5;
+  s.SetOptimizer(CreateOptimizer<double>(config));
+
+  // enough keys to shift clusters and rehash while the gradients are applied
+  const int n = 1000;
+  third_party::SArray<Key> s_keys(n);
+  third_party::SArray<double> s_grads(n);
+  for (int i = 0; i < n; ++i) {
+    s_keys[i] = i * 17;
+    s_grads[i] = i;
+  }
+  s.SubAdd(s_keys, third_party::SArray<char>(s_grads));
+  s.SubAdd(s_keys, third_party::SArray<char>(s_grads));
+
+  third_party::SArray<double> ret = third_party::SArray<double>(s.SubGet(s_keys));
+  for (int i = 0; i < n; ++i) {
+    EXPECT_DOUBLE_EQ(ret[i], -1.0 * i);
+  }
+}
+
+TEST_F(TestHashStorage, Rows) {
+  HashStorage<double> s(0, UpdateMode::Assign, 4);
+
+  // enough keys to rehash, which must move whole rows
+  third_party::SArray<Key> keys;
+  third_party::SArray<double> vals;
+  for (Key k = 0; k < 100; ++k) {
+    keys.push_back(k * 7919);
+    for (int j = 0; j < 4; ++j) vals.push_back(k + j * 0.25);
+  }
+  s.SubAdd(keys, third_party::SArray<char>(vals));
+  EXPECT_EQ(s.Size(), 100);
+
+  keys.push_back(1);  // missing
+  auto ret = third_party::SArray<double>(s.SubGet(keys));
+  ASSERT_EQ(ret.size(), 404);
+  for (int i = 0; i < 400; ++i) EXPECT_DOUBLE_EQ(ret[i], vals[i]);
+  for (int i = 400; i < 404; ++i) EXPECT_DOUBLE_EQ(ret[i], 0);
+}
+
+TEST_F(TestHashStorage, MergeDelta) {
+  HashStorage<int> s(0, UpdateMode::Accumulate, 2);
+  auto delta = s.CreateDelta();
+  third_party::SArray<Key> keys({5, 9, 5});
+  third_party::SArray<int> vals({1, 2, 3, 4, 5, 6});
+  delta->SubAdd(keys, third_party::SArray<char>(vals));
+  s.SubAdd(keys, third_party::SArray<char>(vals));
+  s.MergeDelta(*delta);
+
+  auto ret = third_party::SArray<int>(s.SubGet(third_party::SArray<Key>({5, 9})));
+  ASSERT_EQ(ret.size(), 4);
+  EXPECT_EQ(ret[0], 12);
+  EXPECT_EQ(ret[1], 16);
+  EXPECT_EQ(ret[2], 6);
+  EXPECT_EQ(ret[3], 8);
+}
+
+TEST_F(TestHashStorage, AddBatch) {
+  HashStorage<int> s(0, UpdateMode::Accumulate);
+  std::vector<Message> msgs(3);
+  for (int i = 0; i < 3; ++i) {
+    msgs[i].AddData(third_party::SArray<Key>({Key(3), Key(i)}));
+    msgs[i].AddData(third_party::SArray<int>({1, 10}));
+  }
+  s.AddBatch(msgs);
+
+  auto ret = third_party::SArray<int>(s.SubGet(third_party::SArray<Key>({0, 1, 2, 3})));
+  ASSERT_EQ(ret.size(), 4);
+  EXPECT_EQ(ret[0], 10);
+  EXPECT_EQ(ret[1], 10);
+  EXPECT_EQ(ret[2], 10);
+  EXPECT_EQ(ret[3], 3);
+}
+
+TEST_F(TestHashStorage, Initializer) {
+  HashStorage<float> s(0, UpdateMode::Accumulate, 2);
+  InitializerConfig config;
+  config.type = InitializerType::Uniform;
+  config.seed = 7;
+  Initializer initializer(config);
+  s.SetInitializer(initializer);
+
+  third_party::SArray<Key> keys;
+  for (Key k = 0; k < 100; ++k) keys.push_back(k);
+  auto ret = third_party::SArray<float>(s.SubGet(keys));
+  EXPECT_EQ(s.Size(), 0);
+  for (Key k = 0; k < 100; ++k) {
+    EXPECT_FLOAT_EQ(ret[2 * k], static_cast<float>(initializer.Value(k, 0)));
+    EXPECT_FLOAT_EQ(ret[2 * k + 1], static_cast<float>(initializer.Value(k, 1)));
+  }
+
+  // inserting, also through rehashes, keeps the initial values
+  third_party::SArray<float> ones(200, 1);
+  s.SubAdd(keys, third_party::SArray<char>(ones));
+  auto ret2 = third_party::SArray<float>(s.SubGet(keys));
+  for (int i = 0; i < 200; ++i) EXPECT_FLOAT_EQ(ret2[i], ret[i] + 1);
+}
+
+}  // namespace
+}  // namespace csci5570
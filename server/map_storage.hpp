@@ -2,6 +2,9 @@
 
 #include "base/message.hpp"
 #include "server/abstract_storage.hpp"
+#include "server/hash_storage.hpp"
+#include "server/util/initializer.hpp"
+#include "server/util/update_kernels.hpp"
 
 #include "glog/logging.h"
 
@@ -12,29 +15,66 @@ namespace csci5570 {
 template <typename Val>
 class MapStorage : public AbstractStorage {
  public:
-  MapStorage() = default;
+  /**
+   * @param mode    whether an Add overwrites or accumulates into the stored value
+   */
+  explicit MapStorage(UpdateMode mode = UpdateMode::Assign) : mode_(mode) {}
 
   virtual void SubAdd(const third_party::SArray<Key>& typed_keys, 
       const third_party::SArray<char>& vals) override {
-    auto typed_vals = third_party::SArray<Val>(vals);
-    CHECK_EQ(typed_keys.size(), typed_vals.size());
- 
-    for (int i = 0; i < typed_keys.size(); ++i) {
-      storage_[typed_keys[i]] = typed_vals[i];
-    }
+    Apply(mode_, typed_keys, vals);
+  }
+
+  virtual void SubAssign(const third_party::SArray<Key>& typed_keys,
+      const third_party::SArray<char>& vals) override {
+    Apply(UpdateMode::Assign, typed_keys, vals);
   }
 
   virtual third_party::SArray<char> SubGet(const third_party::SArray<Key>& typed_keys) override {
     third_party::SArray<Val> reply_vals(typed_keys.size());
 
-    // may not find key??
-    for (int i = 0; i < typed_keys.size(); ++i) reply_vals[i] = storage_[typed_keys[i]];
+    // reading an unseen key does not insert it
+    for (int i = 0; i < typed_keys.size(); ++i) {
+      auto it = storage_.find(typed_keys[i]);
+      if (it != storage_.end()) {
+        reply_vals[i] = it->second;
+      } else {
+        initializer_.Fill(typed_keys[i], &reply_vals[i], 1);
+      }
+    }
     return third_party::SArray<char>(reply_vals);
   }
 
+  virtual std::unique_ptr<AbstractStorage> CreateDelta() const override {
+    return std::unique_ptr<AbstractStorage>(new HashStorage<Val>(0, mode_));
+  }
+
   virtual void FinishIter() override {}
 
+  /**
+   * Set the values of keys that have not been added to
+   */
+  void SetInitializer(const Initializer& initializer) { initializer_ = initializer; }
+
+  size_t Size() const { return storage_.size(); }
+
  private:
+  void Apply(UpdateMode mode, const third_party::SArray<Key>& typed_keys, const third_party::SArray<char>& vals) {
+    auto typed_vals = third_party::SArray<Val>(vals);
+    CHECK_EQ(typed_keys.size(), typed_vals.size());
+
+    for (int i = 0; i < typed_keys.size(); ++i) {
+      auto it = storage_.find(typed_keys[i]);
+      if (it == storage_.end()) {
+        it = storage_.emplace(typed_keys[i], Val()).first;
+        initializer_.Fill(typed_keys[i], &it->second, 1);
+      }
+      ApplyOne(mode, &it->second, typed_vals[i]);
+    }
+  }
+
+  UpdateMode mode_;
+  Initializer initializer_;
   std::map<Key, Val> storage_;
 };
 
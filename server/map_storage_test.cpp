@@ -74,5 +74,39 @@ TEST_F(TestMapStorage, SubAddSubGet) {
   }
 }
 
+TEST_F(TestMapStorage, Accumulate) {
+  MapStorage<int> s(UpdateMode::Accumulate);
+
+  third_party::SArray<Key> s_keys({13, 14, 13});
+  third_party::SArray<int> s_vals({1, 2, 3});
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+  third_party::SArray<int> ret = third_party::SArray<int>(s.SubGet(third_party::SArray<Key>({13, 14})));
+  EXPECT_EQ(ret[0], 8);
+  EXPECT_EQ(ret[1], 4);
+}
+
+TEST_F(TestMapStorage, GetDoesNotInsert) {
+  MapStorage<double> s(UpdateMode::Accumulate);
+  InitializerConfig config;
+  config.type = InitializerType::Constant;
+  config.value = 1;
+  s.SetInitializer(Initializer(config));
+
+  third_party::SArray<Key> keys({3, 5});
+  auto ret = third_party::SArray<double>(s.SubGet(keys));
+  ASSERT_EQ(ret.size(), 2);
+  EXPECT_DOUBLE_EQ(ret[0], 1);
+  EXPECT_DOUBLE_EQ(ret[1], 1);
+  EXPECT_EQ(s.Size(), 0);
+
+  // the first add starts from the initial value
+  s.SubAdd(third_party::SArray<Key>({3}), third_party::SArray<char>(third_party::SArray<double>({0.5})));
+  ret = third_party::SArray<double>(s.SubGet(keys));
+  EXPECT_DOUBLE_EQ(ret[0], 1.5);
+  EXPECT_DOUBLE_EQ(ret[1], 1);
+  EXPECT_EQ(s.Size(), 1);
+}
+
 }  // namespace
 }  // namespace csci5570
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "base/message.hpp"
+#include "base/third_party/range.h"
+#include "server/abstract_storage.hpp"
+#include "server/hash_storage.hpp"
+#include "server/util/initializer.hpp"
+#include "server/util/mapped_file.hpp"
+#include "server/util/update_kernels.hpp"
+
+#include "glog/logging.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace csci5570 {
+
+/**
+ * Storage whose values live in a memory-mapped file, for models larger than the RAM of a server
+ *
+ * The rows of values are laid out contiguously in the file and the page cache keeps the hot ones in memory.
+ * The index from keys to rows is either dense over the key range of the shard, or a hash index kept in RAM
+ * that assigns rows in the order keys are first added. Before copying out a batch of rows SubGet asks the
+ * kernel to read the pages of the batch ahead, which turns the page faults of a sorted batch into sequential reads.
+ */
+template <typename Val>
+class MmapStorage : public AbstractStorage {
+ public:
+  /**
+   * Dense index over a key range
+   *
+   * @param path        the file backing this shard
+   * @param range       the key range [begin, end) owned by this server thread
+   * @param mode        whether an Add overwrites or accumulates into the stored value
+   * @param row_width   the number of values per key
+   */
+  MmapStorage(const std::string& path, const third_party::Range& range, UpdateMode mode = UpdateMode::Assign,
+              size_t row_width = 1)
+      : dense_(true), range_(range), mode_(mode), row_width_(row_width), file_(path, range.size() * RowBytes()) {
+    CHECK_GT(row_width_, 0);
+  }
+
+  /**
+   * Hash index over arbitrary keys
+   *
+   * @param path        the file backing this shard
+   * @param size_hint   the expected number of keys, used to size the file up front
+   * @param mode        whether an Add overwrites or accumulates into the stored value
+   * @param row_width   the number of values per key
+   */
+  MmapStorage(const std::string& path, size_t size_hint, UpdateMode mode = UpdateMode::Assign, size_t row_width = 1)
+      : dense_(false), mode_(mode), row_width_(row_width), file_(path, 0) {
+    CHECK_GT(row_width_, 0);
+    index_.reserve(size_hint);
+    Grow(size_hint > kMinRows ? size_hint : kMinRows);
+  }
+
+  virtual void SubAdd(const third_party::SArray<Key>& typed_keys,
+      const third_party::SArray<char>& vals) override {
+    auto typed_vals = third_party::SArray<Val>(vals);
+    CHECK_EQ(typed_keys.size() * row_width_, typed_vals.size());
+    Apply(mode_, typed_keys, typed_vals);
+  }
+
+  virtual void SubAssign(const third_party::SArray<Key>& typed_keys,
+      const third_party::SArray<char>& vals) override {
+    auto typed_vals = third_party::SArray<Val>(vals);
+    CHECK_EQ(typed_keys.size() * row_width_, typed_vals.size());
+    Apply(UpdateMode::Assign, typed_keys, typed_vals);
+  }
+
+  virtual third_party::SArray<char> SubGet(const third_party::SArray<Key>& typed_keys) override {
+    Prefetch(typed_keys);
+    third_party::SArray<Val> reply_vals(typed_keys.size() * row_width_);
+    for (int i = 0; i < typed_keys.size(); ++i) {
+      auto row = Find(typed_keys[i]);
+      auto* dst = reply_vals.data() + i * row_width_;
+      if (row == kNotFound) {
+        initializer_.Fill(typed_keys[i], dst, row_width_);
+      } else {
+        memcpy(dst, Row(row), RowBytes());
+      }
+    }
+    return third_party::SArray<char>(reply_vals);
+  }
+
+  virtual std::unique_ptr<AbstractStorage> CreateDelta() const override {
+    return std::unique_ptr<AbstractStorage>(new HashStorage<Val>(0, mode_, row_width_));
+  }
+
+  virtual void FinishIter() override {}
+
+  /**
+   * Set the values of keys that have not been added to
+   * A dense index writes the initial values of the whole range through the file once
+   */
+  void SetInitializer(const Initializer& initializer) {
+    initializer_ = initializer;
+    if (!dense_ || initializer_.IsZero()) return;
+    for (Key key = range_.begin(); key < range_.end(); ++key) initializer_.Fill(key, Row(Find(key)), row_width_);
+  }
+
+  // the number of keys with a row in the file
+  size_t Size() const { return dense_ ? range_.size() : index_.size(); }
+  const std::string& GetPath() const { return file_.path(); }
+
+ private:
+  static const size_t kNotFound = static_cast<size_t>(-1);
+  static const size_t kMinRows = 1024;
+  // smaller batches are left to the page faults, an madvise call costs more than it saves
+  static const size_t kMinPrefetchKeys = 16;
+
+  void Apply(UpdateMode mode, const third_party::SArray<Key>& typed_keys, const third_party::SArray<Val>& typed_vals) {
+    for (int i = 0; i < typed_keys.size(); ++i) {
+      ApplyRun(mode, Row(FindOrInsert(typed_keys[i])), typed_vals.data() + i * row_width_, row_width_);
+    }
+  }
+
+  size_t RowBytes() const { return row_width_ * sizeof(Val); }
+  Val* Row(size_t row) const { return reinterpret_cast<Val*>(file_.data()) + row * row_width_; }
+
+  size_t Find(Key key) const {
+    if (dense_) {
+      DCHECK(range_.begin() <= key && key < range_.end()) << "key " << key << " is out of the range of this server";
+      return key - range_.begin();
+    }
+    auto it = index_.find(key);
+    return it == index_.end() ? kNotFound : it->second;
+  }
+
+  size_t FindOrInsert(Key key) {
+    if (dense_) return Find(key);
+    auto it = index_.find(key);
+    if (it != index_.end()) return it->second;
+    size_t row = index_.size();
+    if (row == capacity_) Grow(capacity_ * 2);
+    index_.emplace(key, row);
+    if (!initializer_.IsZero()) initializer_.Fill(key, Row(row), row_width_);  // new rows of the file are zero
+    return row;
+  }
+
+  void Grow(size_t capacity) {
+    file_.Resize(capacity * RowBytes());
+    // rows of a hash index are scattered over the file, so readahead around a fault would mostly load cold rows
+    file_.Advise(0, file_.size(), MADV_RANDOM);
+    capacity_ = capacity;
+  }
+
+  void Prefetch(const third_party::SArray<Key>& keys) {
+    if (keys.size() < kMinPrefetchKeys) return;
+    std::vector<size_t> offsets;
+    offsets.reserve(keys.size());
+    for (auto key : keys) {
+      auto row = Find(key);
+      if (row != kNotFound) offsets.push_back(row * RowBytes());
+    }
+    if (offsets.empty()) return;
+    if (!std::is_sorted(offsets.begin(), offsets.end())) std::sort(offsets.begin(), offsets.end());
+    // merge rows less than a page apart into one advised extent
+    size_t page = MappedFile::PageSize();
+    size_t begin = offsets[0];
+    size_t end = begin + RowBytes();
+    for (auto offset : offsets) {
+      if (offset > end + page) {
+        file_.Advise(begin, end - begin, MADV_WILLNEED);
+        begin = offset;
+      }
+      end = std::max(end, offset + RowBytes());
+    }
+    file_.Advise(begin, end - begin, MADV_WILLNEED);
+  }
+
+  bool dense_;
+  third_party::Range range_;  // the key range of a dense index
+  UpdateMode mode_;
+  size_t row_width_;
+  MappedFile file_;
+  Initializer initializer_;
+  std::unordered_map<Key, size_t> index_;  // key -> row, for a hash index
+  size_t capacity_ = 0;                    // the number of rows the file can hold, for a hash index
+};
+
+}  // namespace csci5570
@@ -0,0 +1,65 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/mmap_storage.hpp"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+
+namespace csci5570 {
+namespace {
+
+class TestMmapStorage : public testing::Test {
+ public:
+  TestMmapStorage() {}
+  ~TestMmapStorage() {}
+
+ protected:
+  void SetUp() { path_ = "/tmp/csci5570_mmap_storage_test_" + std::to_string(getpid()); }
+  void TearDown() { std::remove(path_.c_str()); }
+
+  std::string path_;
+};
+
+TEST_F(TestMmapStorage, DenseAddGet) {
+  MmapStorage<double> s(path_, third_party::Range(100, 200));
+
+  third_party::SArray<Key> s_keys({100, 150, 199});
+  third_party::SArray<double> s_vals({0.1, 0.5, 0.9});
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+
+  third_party::SArray<Key> get_keys({100, 101, 150, 199});
+  auto ret = third_party::SArray<double>(s.SubGet(get_keys));
+  ASSERT_EQ(ret.size(), 4);
+  EXPECT_DOUBLE_EQ(ret[0], 0.1);
+  EXPECT_DOUBLE_EQ(ret[1], 0.0);  // untouched keys read as zero
+  EXPECT_DOUBLE_EQ(ret[2], 0.5);
+  EXPECT_DOUBLE_EQ(ret[3], 0.9);
+}
+
+TEST_F(TestMmapStorage, HashedGrowRows) {
+  // starts with room for 1024 rows, so this grows the file a few times
+  MmapStorage<float> s(path_, 0, UpdateMode::Accumulate, 2);
+  third_party::SArray<Key> keys;
+  third_party::SArray<float> vals;
+  for (Key k = 0; k < 5000; ++k) {
+    keys.push_back(k * 104729);
+    vals.push_back(k);
+    vals.push_back(-1.0 * k);
+  }
+  s.SubAdd(keys, third_party::SArray<char>(vals));
+  s.SubAdd(keys, third_party::SArray<char>(vals));
+  EXPECT_EQ(s.Size(), 5000);
+
+  keys.push_back(7);  // missing
+  auto ret = third_party::SArray<float>(s.SubGet(keys));
+  ASSERT_EQ(ret.size(), 10002);
+  for (int i = 0; i < 10000; ++i) EXPECT_FLOAT_EQ(ret[i], 2 * vals[i]);
+  EXPECT_FLOAT_EQ(ret[10000], 0);
+  EXPECT_FLOAT_EQ(ret[10001], 0);
+}
+
+}  // namespace
+}  // namespace csci5570
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+
+namespace csci5570 {
+
+enum class OptimizerType { None, SGD, Adagrad, Adam, FTRL };
+
+/**
+ * Hyper-parameters of the server-side optimizers, each optimizer reads the fields it needs
+ */
+struct OptimizerConfig {
+  OptimizerType type = OptimizerType::None;  // None keeps the UpdateMode semantics of the table
+  double learning_rate = 0.01;               // also the alpha of FTRL
+  double epsilon = 1e-8;                     // Adagrad, Adam
+  double beta1 = 0.9;                        // Adam
+  double beta2 = 0.999;                      // Adam
+  double beta = 1.0;                         // FTRL
+  double l1 = 0.0;                           // FTRL
+  double l2 = 0.0;                           // FTRL
+};
+
+/**
+ * An update rule that the storage applies to the gradients pushed by Add
+ *
+ * The storage owns the weights and GetNumStates() auxiliary arrays of the same length (struct of arrays),
+ * and tells the optimizer which slot of these arrays each gradient belongs to.
+ */
+template <typename Val>
+class AbstractOptimizer {
+ public:
+  virtual ~AbstractOptimizer() {}
+
+  /**
+   * The number of auxiliary values kept per key, e.g. the two moments of Adam
+   */
+  virtual int GetNumStates() const = 0;
+
+  /**
+   * Apply n gradients
+   *
+   * @param slots     the position of each gradient in weights and states
+   * @param grads     the gradients
+   * @param n         the number of gradients
+   * @param weights   the weight array
+   * @param states    GetNumStates() arrays parallel to weights
+   */
+  virtual void Update(const size_t* slots, const Val* grads, size_t n, Val* weights, Val* const* states) = 0;
+};
+
+}  // namespace csci5570
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "server/optimizer/abstract_optimizer.hpp"
+
+#include <cmath>
+
+namespace csci5570 {
+
+/**
+ * Adagrad, states: [sum of squared gradients]
+ *
+ * n += g^2, w -= learning_rate * g / (sqrt(n) + epsilon)
+ */
+template <typename Val>
+class AdagradOptimizer : public AbstractOptimizer<Val> {
+ public:
+  explicit AdagradOptimizer(const OptimizerConfig& config)
+      : learning_rate_(config.learning_rate), epsilon_(config.epsilon) {}
+
+  virtual int GetNumStates() const override { return 1; }
+
+  virtual void Update(const size_t* slots, const Val* grads, size_t n, Val* weights, Val* const* states) override {
+    Val* sum_sq = states[0];
+    for (size_t i = 0; i < n; ++i) {
+      auto slot = slots[i];
+      double g = grads[i];
+      sum_sq[slot] += static_cast<Val>(g * g);
+      weights[slot] -= static_cast<Val>(learning_rate_ * g / (std::sqrt(static_cast<double>(sum_sq[slot])) + epsilon_));
+    }
+  }
+
+ private:
+  double learning_rate_;
+  double epsilon_;
+};
+
+}  // namespace csci5570
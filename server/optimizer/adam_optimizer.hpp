@@ -0,0 +1,52 @@
+#pragma once
+
+#include "server/optimizer/abstract_optimizer.hpp"
+
+#include <cmath>
+
+namespace csci5570 {
+
+/**
+ * Adam, states: [first moment, second moment, number of updates of the key]
+ *
+ * The bias correction uses the update count of each key, so keys of sparse models that are rarely
+ * touched are not over-corrected.
+ */
+template <typename Val>
+class AdamOptimizer : public AbstractOptimizer<Val> {
+ public:
+  explicit AdamOptimizer(const OptimizerConfig& config)
+      : learning_rate_(config.learning_rate),
+        epsilon_(config.epsilon),
+        beta1_(config.beta1),
+        beta2_(config.beta2) {}
+
+  virtual int GetNumStates() const override { return 3; }
+
+  virtual void Update(const size_t* slots, const Val* grads, size_t n, Val* weights, Val* const* states) override {
+    Val* m = states[0];
+    Val* v = states[1];
+    Val* t = states[2];
+    for (size_t i = 0; i < n; ++i) {
+      auto slot = slots[i];
+      double g = grads[i];
+      double step = static_cast<double>(t[slot]) + 1;
+      double m_new = beta1_ * m[slot] + (1 - beta1_) * g;
+      double v_new = beta2_ * v[slot] + (1 - beta2_) * g * g;
+      double m_hat = m_new / (1 - std::pow(beta1_, step));
+      double v_hat = v_new / (1 - std::pow(beta2_, step));
+      m[slot] = static_cast<Val>(m_new);
+      v[slot] = static_cast<Val>(v_new);
+      t[slot] = static_cast<Val>(step);
+      weights[slot] -= static_cast<Val>(learning_rate_ * m_hat / (std::sqrt(v_hat) + epsilon_));
+    }
+  }
+
+ private:
+  double learning_rate_;
+  double epsilon_;
+  double beta1_;
+  double beta2_;
+};
+
+}  // namespace csci5570
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "server/optimizer/abstract_optimizer.hpp"
+
+#include <cmath>
+
+namespace csci5570 {
+
+/**
+ * FTRL-Proximal, states: [z, n]
+ *
+ * The weight is recomputed from z and n in closed form on every update, keys with |z| <= l1 become exactly 0.
+ */
+template <typename Val>
+class FTRLOptimizer : public AbstractOptimizer<Val> {
+ public:
+  explicit FTRLOptimizer(const OptimizerConfig& config)
+      : alpha_(config.learning_rate), beta_(config.beta), l1_(config.l1), l2_(config.l2) {}
+
+  virtual int GetNumStates() const override { return 2; }
+
+  virtual void Update(const size_t* slots, const Val* grads, size_t n, Val* weights, Val* const* states) override {
+    Val* z = states[0];
+    Val* sum_sq = states[1];
+    for (size_t i = 0; i < n; ++i) {
+      auto slot = slots[i];
+      double g = grads[i];
+      double n_old = sum_sq[slot];
+      double n_new = n_old + g * g;
+      double sigma = (std::sqrt(n_new) - std::sqrt(n_old)) / alpha_;
+      double z_new = z[slot] + g - sigma * weights[slot];
+      z[slot] = static_cast<Val>(z_new);
+      sum_sq[slot] = static_cast<Val>(n_new);
+      if (std::abs(z_new) <= l1_) {
+        weights[slot] = Val();
+      } else {
+        double sign = z_new < 0 ? -1 : 1;
+        weights[slot] = static_cast<Val>(-(z_new - sign * l1_) / ((beta_ + std::sqrt(n_new)) / alpha_ + l2_));
+      }
+    }
+  }
+
+ private:
+  double alpha_;
+  double beta_;
+  double l1_;
+  double l2_;
+};
+
+}  // namespace csci5570
@@ -0,0 +1,91 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/optimizer/optimizers.hpp"
+
+#include <cmath>
+#include <vector>
+
+namespace csci5570 {
+namespace {
+
+class TestOptimizer : public testing::Test {
+ public:
+  TestOptimizer() {}
+  ~TestOptimizer() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+// apply the gradients one by one to slot 1 of a 2-slot model and return the weight
+double ApplyGrads(const OptimizerConfig& config, const std::vector<double>& grads, std::vector<std::vector<double>>* states) {
+  auto optimizer = CreateOptimizer<double>(config);
+  std::vector<double> weights(2, 0.0);
+  states->assign(optimizer->GetNumStates(), std::vector<double>(2, 0.0));
+  std::vector<double*> state_ptrs;
+  for (auto& state : *states) state_ptrs.push_back(state.data());
+  size_t slot = 1;
+  for (auto g : grads) {
+    optimizer->Update(&slot, &g, 1, weights.data(), state_ptrs.data());
+  }
+  EXPECT_EQ(weights[0], 0.0);  // other slots are untouched
+  return weights[1];
+}
+
+TEST_F(TestOptimizer, None) {
+  OptimizerConfig config;
+  EXPECT_EQ(CreateOptimizer<double>(config), nullptr);
+}
+
+TEST_F(TestOptimizer, SGD) {
+  OptimizerConfig config;
+  config.type = OptimizerType::SGD;
+  config.learning_rate = 0.1;
+  std::vector<std::vector<double>> states;
+  EXPECT_DOUBLE_EQ(ApplyGrads(config, {1.0, 2.0}, &states), -0.3);
+  EXPECT_TRUE(states.empty());
+}
+
+TEST_F(TestOptimizer, Adagrad) {
+  OptimizerConfig config;
+  config.type = OptimizerType::Adagrad;
+  config.learning_rate = 0.1;
+  config.epsilon = 0;
+  std::vector<std::vector<double>> states;
+  double w = ApplyGrads(config, {3.0, 4.0}, &states);
+  EXPECT_DOUBLE_EQ(states[0][1], 25.0);
+  EXPECT_DOUBLE_EQ(w, -0.1 * 3.0 / 3.0 - 0.1 * 4.0 / 5.0);
+}
+
+TEST_F(TestOptimizer, Adam) {
+  OptimizerConfig config;
+  config.type = OptimizerType::Adam;
+  config.learning_rate = 0.1;
+  std::vector<std::vector<double>> states;
+  double w = ApplyGrads(config, {2.0}, &states);
+  // the bias-corrected first step moves by about learning_rate in the direction of -g
+  EXPECT_NEAR(w, -0.1, 1e-6);
+  EXPECT_DOUBLE_EQ(states[0][1], 0.2);    // first moment
+  EXPECT_NEAR(states[1][1], 0.004, 1e-12);  // second moment
+  EXPECT_DOUBLE_EQ(states[2][1], 1.0);    // step of the key
+}
+
+TEST_F(TestOptimizer, FTRL) {
+  OptimizerConfig config;
+  config.type = OptimizerType::FTRL;
+  config.learning_rate = 1.0;
+  config.beta = 1.0;
+  config.l1 = 1.0;
+  std::vector<std::vector<double>> states;
+  // |z| stays within l1, the weight is clipped to 0
+  EXPECT_DOUBLE_EQ(ApplyGrads(config, {0.5}, &states), 0.0);
+  // z = 3, n = 9: w = -(3 - 1) / ((1 + 3) / 1)
+  EXPECT_DOUBLE_EQ(ApplyGrads(config, {3.0}, &states), -0.5);
+  EXPECT_DOUBLE_EQ(states[0][1], 3.0);
+  EXPECT_DOUBLE_EQ(states[1][1], 9.0);
+}
+
+}  // namespace
+}  // namespace csci5570
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "server/optimizer/abstract_optimizer.hpp"
+#include "server/optimizer/adagrad_optimizer.hpp"
+#include "server/optimizer/adam_optimizer.hpp"
+#include "server/optimizer/ftrl_optimizer.hpp"
+#include "server/optimizer/sgd_optimizer.hpp"
+
+#include <memory>
+
+namespace csci5570 {
+
+/**
+ * Create the optimizer described by config, or nullptr for OptimizerType::None
+ */
+template <typename Val>
+std::unique_ptr<AbstractOptimizer<Val>> CreateOptimizer(const OptimizerConfig& config) {
+  std::unique_ptr<AbstractOptimizer<Val>> optimizer;
+  switch (config.type) {
+    case OptimizerType::None:
+      break;
+    case OptimizerType::SGD:
+      optimizer.reset(new SGDOptimizer<Val>(config));
+      break;
+    case OptimizerType::Adagrad:
+      optimizer.reset(new AdagradOptimizer<Val>(config));
+      break;
+    case OptimizerType::Adam:
+      optimizer.reset(new AdamOptimizer<Val>(config));
+      break;
+    case OptimizerType::FTRL:
+      optimizer.reset(new FTRLOptimizer<Val>(config));
+      break;
+  }
+  return optimizer;
+}
+
+}  // namespace csci5570
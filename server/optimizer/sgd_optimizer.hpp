@@ -0,0 +1,27 @@
+#pragma once
+
+#include "server/optimizer/abstract_optimizer.hpp"
+
+namespace csci5570 {
+
+/**
+ * w -= learning_rate * g
+ */
+template <typename Val>
+class SGDOptimizer : public AbstractOptimizer<Val> {
+ public:
+  explicit SGDOptimizer(const OptimizerConfig& config) : learning_rate_(config.learning_rate) {}
+
+  virtual int GetNumStates() const override { return 0; }
+
+  virtual void Update(const size_t* slots, const Val* grads, size_t n, Val* weights, Val* const* states) override {
+    for (size_t i = 0; i < n; ++i) {
+      weights[slots[i]] -= static_cast<Val>(learning_rate_ * grads[i]);
+    }
+  }
+
+ private:
+  double learning_rate_;
+};
+
+}  // namespace csci5570
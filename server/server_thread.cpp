@@ -4,40 +4,158 @@
 
 namespace csci5570 {
 
+const size_t ServerThread::kMaxAddsPerTurn;
+
 void ServerThread::RegisterModel(uint32_t model_id, std::unique_ptr<AbstractModel>&& model) {
     // insert model, if existed update model
+    std::lock_guard<std::mutex> lk(mu_);
     models_[model_id] = std::move(model);
+    if (model_queues_.find(model_id) == model_queues_.end()) {
+        std::lock_guard<std::mutex> queues_lk(queues_mu_);
+        model_queues_[model_id].reset(new ModelQueue());
+        model_order_.push_back(model_id);
+    }
 }
 
 AbstractModel* ServerThread::GetModel(uint32_t model_id) {
     // return model if existed, otherwise return nullptr
+    std::lock_guard<std::mutex> lk(mu_);
     auto it = models_.find(model_id);
     return (it != models_.end()) ? it->second.get() : nullptr;
 }
 
+ModelQueueStats ServerThread::GetQueueStats(uint32_t model_id) const {
+    ModelQueueStats stats;
+    std::lock_guard<std::mutex> lk(queues_mu_);
+    auto it = model_queues_.find(model_id);
+    if (it == model_queues_.end()) return stats;
+    auto& queue = *it->second;
+    stats.num_queued_adds = queue.num_queued_adds.load(std::memory_order_relaxed);
+    stats.num_queued_others = queue.num_queued_others.load(std::memory_order_relaxed);
+    stats.num_served = queue.num_served.load(std::memory_order_relaxed);
+    stats.total_wait_us = queue.total_wait_us.load(std::memory_order_relaxed);
+    stats.max_wait_us = queue.max_wait_us.load(std::memory_order_relaxed);
+    return stats;
+}
+
 void ServerThread::Main() {
     DLOG(INFO) << "Server " << id_ << " is running";
-    Message msg;
+    std::vector<Message> msgs;
+    std::vector<std::chrono::steady_clock::time_point> arrivals;
+    bool running = true;
+    bool idle = true;
     while (true) {
-        GetWorkQueue()->WaitAndPop(&msg);
-        if (msg.meta.flag == Flag::kExit) break;
-        auto *model = GetModel(msg.meta.model_id);
-        switch (msg.meta.flag) {
+        // block only when every model is idle, otherwise pick up new messages between two rounds
+        if (running) {
+            if (idle) {
+                GetWorkQueue()->WaitAndPopAll(&msgs, &arrivals);
+            } else {
+                GetWorkQueue()->TryPopAll(&msgs, &arrivals);
+            }
+        }
+        std::lock_guard<std::mutex> lk(mu_);
+        if (running && !msgs.empty()) running = Route(msgs, arrivals);
+        msgs.clear();
+        for (auto model_id : model_order_) Serve(model_id);
+        idle = !HasQueuedWork();
+        // the messages before kExit are still served
+        if (!running && idle) break;
+    }
+}
+
+bool ServerThread::Route(std::vector<Message>& msgs,
+                         const std::vector<std::chrono::steady_clock::time_point>& arrivals) {
+    for (size_t i = 0; i < msgs.size(); ++i) {
+        auto& msg = msgs[i];
+        if (msg.meta.flag == Flag::kExit) return false;
+        auto it = model_queues_.find(msg.meta.model_id);
+        CHECK(it != model_queues_.end()) << "model " << msg.meta.model_id << " is not on server " << id_;
+        auto& queue = *it->second;
+        if (msg.meta.flag == Flag::kAdd) {
+            queue.adds.push_back({std::move(msg), next_seq_++, arrivals[i]});
+            queue.num_queued_adds.store(queue.adds.size(), std::memory_order_relaxed);
+        } else {
+            queue.others.push_back({std::move(msg), next_seq_++, arrivals[i]});
+            queue.num_queued_others.store(queue.others.size(), std::memory_order_relaxed);
+        }
+    }
+    return true;
+}
+
+bool ServerThread::HasQueuedWork() const {
+    for (auto& model_queue : model_queues_) {
+        if (!model_queue.second->adds.empty() || !model_queue.second->others.empty()) return true;
+    }
+    return false;
+}
+
+void ServerThread::Serve(uint32_t model_id) {
+    auto* queue = model_queues_.at(model_id).get();
+    auto* model = models_.at(model_id).get();
+    while (!queue->others.empty()) {
+        auto& queued = queue->others.front();
+        if (queued.msg.meta.flag == Flag::kGet) {
+            // a worker reads its own Adds, and the Adds that arrived before them are applied first to keep their order
+            ApplyAdds(model_id, AfterLastAdd(*queue, queued.msg.meta.sender, queued.seq), queue->adds.size());
+        } else {
+            // the Adds a worker sent before its Clock belong to the clock being finished
+            ApplyAdds(model_id, queued.seq, queue->adds.size());
+        }
+        RecordWait(queue, queued);
+        switch (queued.msg.meta.flag) {
             case Flag::kClock:
-                model->Clock(msg);
-                break;
-            case Flag::kAdd:
-                model->Add(msg);
+                model->Clock(queued.msg);
                 break;
             case Flag::kGet:
-                model->Get(msg);
+                model->Get(queued.msg);
                 break;
             case Flag::kResetWorkerInModel:
-                model->ResetWorker(msg);
+                model->ResetWorker(queued.msg);
+                break;
+            case Flag::kSubscribe:
+                model->Subscribe(queued.msg);
+                break;
+            default:
+                LOG(WARNING) << "server " << id_ << " ignores "
+                             << FlagName[static_cast<int>(queued.msg.meta.flag)];
                 break;
         }
+        queue->others.pop_front();
+        queue->num_queued_others.store(queue->others.size(), std::memory_order_relaxed);
     }
+    ApplyAdds(model_id, next_seq_, kMaxAddsPerTurn);
 }
 
-}  // namespace csci5570
+void ServerThread::ApplyAdds(uint32_t model_id, uint64_t before_seq, size_t max_adds) {
+    auto* queue = model_queues_.at(model_id).get();
+    std::vector<Message> batch;
+    while (!queue->adds.empty() && batch.size() < max_adds && queue->adds.front().seq < before_seq) {
+        RecordWait(queue, queue->adds.front());
+        batch.push_back(std::move(queue->adds.front().msg));
+        queue->adds.pop_front();
+    }
+    queue->num_queued_adds.store(queue->adds.size(), std::memory_order_relaxed);
+    if (!batch.empty()) models_.at(model_id)->AddBatch(batch);
+}
 
+uint64_t ServerThread::AfterLastAdd(const ModelQueue& queue, int sender, uint64_t before_seq) const {
+    uint64_t after = 0;
+    for (auto& queued : queue.adds) {
+        if (queued.seq >= before_seq) break;
+        if (queued.msg.meta.sender == sender) after = queued.seq + 1;
+    }
+    return after;
+}
+
+void ServerThread::RecordWait(ModelQueue* queue, const QueuedMessage& queued) {
+    auto wait = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - queued.arrival).count();
+    queue->num_served.fetch_add(1, std::memory_order_relaxed);
+    queue->total_wait_us.fetch_add(wait, std::memory_order_relaxed);
+    // only the server thread writes the stats
+    if (static_cast<uint64_t>(wait) > queue->max_wait_us.load(std::memory_order_relaxed)) {
+        queue->max_wait_us.store(wait, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace csci5570
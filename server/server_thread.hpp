@@ -4,23 +4,88 @@
 #include "base/threadsafe_queue.hpp"
 #include "server/abstract_model.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 namespace csci5570 {
 
+/**
+ * A snapshot of the queue of one model on a server thread
+ * Waits are measured from when a message is pushed into the work queue of the server thread until it is served
+ */
+struct ModelQueueStats {
+  size_t num_queued_adds = 0;
+  size_t num_queued_others = 0;  // Gets, Clocks and resets
+  uint64_t num_served = 0;
+  uint64_t total_wait_us = 0;
+  uint64_t max_wait_us = 0;
+};
+
+/**
+ * Server thread that keeps one queue per model
+ *
+ * Messages are drained from the work queue into the queue of their model, and the models are served round-robin.
+ * In a turn a model answers all its queued Gets, Clocks and resets, then applies at most kMaxAddsPerTurn of its
+ * Adds in one AddBatch, so a burst of Adds on one table does not hold up the Gets of another. A Get may overtake
+ * the Adds of other workers queued before it, but not those of its own sender, and a Clock or reset is served
+ * only after the Adds that arrived before it.
+ */
 class ServerThread : public Actor {
  public:
-  ServerThread(uint32_t server_id) : Actor(server_id) {}
+  ServerThread(uint32_t server_id) : Actor(server_id) { work_queue_.RecordPushTimes(); }
   
-  // for model maintenance
+  // for model maintenance, tables may be created while the thread is running
   void RegisterModel(uint32_t model_id, std::unique_ptr<AbstractModel>&& model);
   AbstractModel* GetModel(uint32_t model_id);
 
+  // does not wait for the server thread, the stats are kept in atomics
+  ModelQueueStats GetQueueStats(uint32_t model_id) const;
+
+  static const size_t kMaxAddsPerTurn = 64;
+
  protected:
   virtual void Main() override;                                  // where the actor polls events and reacts
 
+  struct QueuedMessage {
+    Message msg;
+    uint64_t seq;  // the order of arrival at this server thread
+    std::chrono::steady_clock::time_point arrival;  // when it was pushed into the work queue
+  };
+
+  struct ModelQueue {
+    std::deque<QueuedMessage> adds;
+    std::deque<QueuedMessage> others;  // Gets, Clocks and resets, in their order of arrival
+    // the stats, written by the server thread only
+    std::atomic<size_t> num_queued_adds{0};
+    std::atomic<size_t> num_queued_others{0};
+    std::atomic<uint64_t> num_served{0};
+    std::atomic<uint64_t> total_wait_us{0};
+    std::atomic<uint64_t> max_wait_us{0};
+  };
+
+  // the following are called by the server thread with mu_ held
+  // put drained messages into the queues of their models, return false once kExit is seen
+  bool Route(std::vector<Message>& msgs, const std::vector<std::chrono::steady_clock::time_point>& arrivals);
+  bool HasQueuedWork() const;
+  // one turn of a model
+  void Serve(uint32_t model_id);
+  // apply at most <max_adds> of the queued Adds that arrived before <before_seq>
+  void ApplyAdds(uint32_t model_id, uint64_t before_seq, size_t max_adds);
+  // the seq just after the last queued Add of <sender> that arrived before <before_seq>, 0 if there is none
+  uint64_t AfterLastAdd(const ModelQueue& queue, int sender, uint64_t before_seq) const;
+  void RecordWait(ModelQueue* queue, const QueuedMessage& queued);
+
+  std::mutex mu_;                 // guards the models and their queues against RegisterModel
+  mutable std::mutex queues_mu_;  // guards model_queues_ itself against RegisterModel for GetQueueStats
   std::unordered_map<uint32_t, std::unique_ptr<AbstractModel>> models_;
+  std::unordered_map<uint32_t, std::unique_ptr<ModelQueue>> model_queues_;
+  std::vector<uint32_t> model_order_;  // the round-robin order of the models
+  uint64_t next_seq_ = 0;
 };
 
 }  // namespace csci5570
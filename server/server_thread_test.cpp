@@ -5,6 +5,11 @@
 #include "server/abstract_model.hpp"
 #include "server/server_thread.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
 namespace csci5570 {
 namespace {
 
@@ -20,15 +25,32 @@ class TestServerThread : public testing::Test {
 
 class FakeModel : public AbstractModel {
  public:
-  virtual void Clock(Message&) override { clock_count_ += 1; }
-  virtual void Add(Message&) override { add_count_ += 1; }
-  virtual void Get(Message&) override { get_count_ += 1; }
+  virtual void Clock(Message&) override {
+    clock_count_ += 1;
+    calls_.push_back(Flag::kClock);
+  }
+  virtual void Add(Message&) override {
+    add_count_ += 1;
+    calls_.push_back(Flag::kAdd);
+  }
+  virtual void Get(Message&) override {
+    get_count_ += 1;
+    calls_.push_back(Flag::kGet);
+    if (on_get_) on_get_();
+  }
+  virtual void AddBatch(std::vector<Message>& msgs) override {
+    batch_sizes_.push_back(msgs.size());
+    AbstractModel::AddBatch(msgs);
+  }
   virtual int GetProgress(int tid) override { return -1; }
   virtual void ResetWorker(Message& msg) override {}
 
   int clock_count_ = 0;
   int add_count_ = 0;
   int get_count_ = 0;
+  std::vector<size_t> batch_sizes_;
+  std::vector<Flag> calls_;
+  std::function<void()> on_get_;
 };
 
 TEST_F(TestServerThread, Construct) { ServerThread server_thread(0); }
@@ -113,5 +135,191 @@ TEST_F(TestServerThread, Get) {
   EXPECT_EQ(p->get_count_, 3);
 }
 
+TEST_F(TestServerThread, BatchedAdds) {
+  ServerThread server_thread(0);
+  std::unique_ptr<AbstractModel> model(new FakeModel());
+  const uint32_t model_id = 0;
+  server_thread.RegisterModel(model_id, std::move(model));
+  auto* p = static_cast<FakeModel*>(server_thread.GetModel(model_id));
+
+  // queue everything before starting, so that the server thread drains it in one batch
+  auto* work_queue = server_thread.GetWorkQueue();
+  Message add_msg;
+  add_msg.meta.flag = Flag::kAdd;
+  add_msg.meta.model_id = model_id;
+  Message clock_msg;
+  clock_msg.meta.flag = Flag::kClock;
+  clock_msg.meta.model_id = model_id;
+  work_queue->Push(add_msg);
+  work_queue->Push(add_msg);
+  work_queue->Push(add_msg);
+  work_queue->Push(clock_msg);
+  work_queue->Push(add_msg);
+
+  Message exit_msg;
+  exit_msg.meta.flag = Flag::kExit;
+  work_queue->Push(exit_msg);
+  server_thread.Start();
+  server_thread.Stop();
+
+  // a Clock splits the Adds into the batches before and after it
+  ASSERT_EQ(p->batch_sizes_.size(), 2);
+  EXPECT_EQ(p->batch_sizes_[0], 3);
+  EXPECT_EQ(p->batch_sizes_[1], 1);
+  EXPECT_EQ(p->add_count_, 4);
+  EXPECT_EQ(p->clock_count_, 1);
+}
+
+TEST_F(TestServerThread, GetsBeforeAdds) {
+  ServerThread server_thread(0);
+  server_thread.RegisterModel(0, std::unique_ptr<AbstractModel>(new FakeModel()));
+  server_thread.RegisterModel(1, std::unique_ptr<AbstractModel>(new FakeModel()));
+  auto* p0 = static_cast<FakeModel*>(server_thread.GetModel(0));
+  auto* p1 = static_cast<FakeModel*>(server_thread.GetModel(1));
+
+  auto* work_queue = server_thread.GetWorkQueue();
+  Message msg;
+  msg.meta.model_id = 0;
+  msg.meta.sender = 1;
+  msg.meta.flag = Flag::kAdd;
+  const int kNumAdds = ServerThread::kMaxAddsPerTurn * 2 + 1;
+  for (int i = 0; i < kNumAdds; ++i) work_queue->Push(msg);
+  msg.meta.sender = 2;
+  msg.meta.flag = Flag::kGet;
+  work_queue->Push(msg);
+  msg.meta.flag = Flag::kClock;
+  work_queue->Push(msg);
+  msg.meta.model_id = 1;
+  msg.meta.flag = Flag::kGet;
+  work_queue->Push(msg);
+
+  Message exit_msg;
+  exit_msg.meta.flag = Flag::kExit;
+  work_queue->Push(exit_msg);
+  server_thread.Start();
+  server_thread.Stop();
+
+  // the Get overtakes the Adds of another worker, the Clock waits for them
+  ASSERT_EQ(p0->calls_.size(), kNumAdds + 2);
+  EXPECT_EQ(p0->calls_[0], Flag::kGet);
+  for (int i = 1; i <= kNumAdds; ++i) EXPECT_EQ(p0->calls_[i], Flag::kAdd);
+  EXPECT_EQ(p0->calls_.back(), Flag::kClock);
+  EXPECT_EQ(p1->get_count_, 1);
+
+  auto stats = server_thread.GetQueueStats(0);
+  EXPECT_EQ(stats.num_queued_adds, 0);
+  EXPECT_EQ(stats.num_queued_others, 0);
+  EXPECT_EQ(stats.num_served, kNumAdds + 2);
+  EXPECT_LE(stats.max_wait_us, stats.total_wait_us);
+  EXPECT_EQ(server_thread.GetQueueStats(1).num_served, 1);
+}
+
+TEST_F(TestServerThread, GetAfterOwnAdds) {
+  ServerThread server_thread(0);
+  server_thread.RegisterModel(0, std::unique_ptr<AbstractModel>(new FakeModel()));
+  auto* p = static_cast<FakeModel*>(server_thread.GetModel(0));
+
+  auto* work_queue = server_thread.GetWorkQueue();
+  Message msg;
+  msg.meta.model_id = 0;
+  msg.meta.flag = Flag::kAdd;
+  for (int sender : {2, 1, 2}) {
+    msg.meta.sender = sender;
+    work_queue->Push(msg);
+  }
+  msg.meta.sender = 1;
+  msg.meta.flag = Flag::kGet;
+  work_queue->Push(msg);
+
+  Message exit_msg;
+  exit_msg.meta.flag = Flag::kExit;
+  work_queue->Push(exit_msg);
+  server_thread.Start();
+  server_thread.Stop();
+
+  // the Get waits for the Add of its sender and the Add before it, not for the Add after it
+  EXPECT_EQ(p->calls_, std::vector<Flag>({Flag::kAdd, Flag::kAdd, Flag::kGet, Flag::kAdd}));
+  ASSERT_EQ(p->batch_sizes_.size(), 2);
+  EXPECT_EQ(p->batch_sizes_[0], 2);
+  EXPECT_EQ(p->batch_sizes_[1], 1);
+}
+
+TEST_F(TestServerThread, AddsInTurns) {
+  ServerThread server_thread(0);
+  server_thread.RegisterModel(0, std::unique_ptr<AbstractModel>(new FakeModel()));
+  auto* p = static_cast<FakeModel*>(server_thread.GetModel(0));
+
+  auto* work_queue = server_thread.GetWorkQueue();
+  Message msg;
+  msg.meta.model_id = 0;
+  msg.meta.flag = Flag::kAdd;
+  for (int i = 0; i < ServerThread::kMaxAddsPerTurn + 1; ++i) work_queue->Push(msg);
+
+  Message exit_msg;
+  exit_msg.meta.flag = Flag::kExit;
+  work_queue->Push(exit_msg);
+  server_thread.Start();
+  server_thread.Stop();
+
+  ASSERT_EQ(p->batch_sizes_.size(), 2);
+  EXPECT_EQ(p->batch_sizes_[0], ServerThread::kMaxAddsPerTurn);
+  EXPECT_EQ(p->batch_sizes_[1], 1);
+}
+
+TEST_F(TestServerThread, WaitInWorkQueue) {
+  ServerThread server_thread(0);
+  server_thread.RegisterModel(0, std::unique_ptr<AbstractModel>(new FakeModel()));
+
+  // the wait starts when the message is pushed, not when the server thread takes it
+  Message msg;
+  msg.meta.model_id = 0;
+  msg.meta.flag = Flag::kGet;
+  server_thread.GetWorkQueue()->Push(msg);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  Message exit_msg;
+  exit_msg.meta.flag = Flag::kExit;
+  server_thread.GetWorkQueue()->Push(exit_msg);
+  server_thread.Start();
+  server_thread.Stop();
+
+  auto stats = server_thread.GetQueueStats(0);
+  EXPECT_EQ(stats.num_served, 1);
+  EXPECT_GE(stats.max_wait_us, 20000);
+}
+
+TEST_F(TestServerThread, QueueStatsWhileServing) {
+  ServerThread server_thread(0);
+  server_thread.RegisterModel(0, std::unique_ptr<AbstractModel>(new FakeModel()));
+  auto* p = static_cast<FakeModel*>(server_thread.GetModel(0));
+  std::atomic<bool> in_get(false);
+  std::atomic<bool> release(false);
+  p->on_get_ = [&] {
+    in_get = true;
+    while (!release) std::this_thread::yield();
+  };
+
+  auto* work_queue = server_thread.GetWorkQueue();
+  Message msg;
+  msg.meta.model_id = 0;
+  msg.meta.flag = Flag::kGet;
+  work_queue->Push(msg);
+  msg.meta.flag = Flag::kAdd;
+  work_queue->Push(msg);
+  server_thread.Start();
+  while (!in_get) std::this_thread::yield();
+
+  // the stats are read while the server thread is in the middle of a round
+  auto stats = server_thread.GetQueueStats(0);
+  EXPECT_EQ(stats.num_queued_adds, 1);
+  EXPECT_EQ(stats.num_served, 1);
+  release = true;
+
+  Message exit_msg;
+  exit_msg.meta.flag = Flag::kExit;
+  work_queue->Push(exit_msg);
+  server_thread.Stop();
+  EXPECT_EQ(server_thread.GetQueueStats(0).num_served, 2);
+}
+
 }  // namespace
 }  // namespace csci5570
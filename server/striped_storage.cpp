@@ -0,0 +1,189 @@
+#include "server/striped_storage.hpp"
+
+#include "glog/logging.h"
+
+#include <cstring>
+
+namespace csci5570 {
+
+const size_t StripedStorage::kMinParallelKeys;
+
+StripedStorage::StripedStorage(std::vector<std::unique_ptr<AbstractStorage>>&& stripes,
+                               const third_party::Range& range, size_t num_threads)
+    : stripes_(std::move(stripes)), ranged_(true), range_(range), pool_(num_threads) {
+  CHECK(!stripes_.empty());
+  CHECK_GE(range_.size(), stripes_.size()) << "more stripes than keys";
+  stripe_ranges_ = SplitRange(range_, stripes_.size());
+}
+
+StripedStorage::StripedStorage(std::vector<std::unique_ptr<AbstractStorage>>&& stripes, size_t num_threads)
+    : stripes_(std::move(stripes)), ranged_(false), pool_(num_threads) {
+  CHECK(!stripes_.empty());
+}
+
+std::vector<third_party::Range> StripedStorage::SplitRange(const third_party::Range& range, size_t num_stripes) {
+  std::vector<third_party::Range> ranges;
+  uint64_t begin = range.begin();
+  for (size_t i = 0; i < num_stripes; ++i) {
+    uint64_t end = range.begin() + range.size() * (i + 1) / num_stripes;
+    ranges.emplace_back(begin, end);
+    begin = end;
+  }
+  return ranges;
+}
+
+size_t StripedStorage::StripeOf(Key key) const {
+  if (ranged_) {
+    DCHECK(range_.begin() <= key && key < range_.end()) << "key " << key << " is out of the range of this server";
+    // the inverse of SplitRange: the last stripe i with range.size() * i / n <= offset
+    uint64_t offset = key - range_.begin();
+    return ((offset + 1) * stripes_.size() - 1) / range_.size();
+  }
+  // splitmix64, independent of the hash that assigned the key to this shard
+  uint64_t x = key + 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return (x ^ (x >> 31)) % stripes_.size();
+}
+
+bool StripedStorage::CutRuns(const third_party::SArray<Key>& keys, std::vector<Run>* runs) const {
+  std::vector<bool> visited(stripes_.size(), false);
+  bool distinct = true;
+  size_t i = 0;
+  while (i < keys.size()) {
+    Run run;
+    run.begin = i;
+    run.stripe = StripeOf(keys[i]);
+    // extend by comparing with the borders of the stripe, without dividing for every key
+    const auto& r = stripe_ranges_[run.stripe];
+    while (++i < keys.size() && r.begin() <= keys[i] && keys[i] < r.end()) {}
+    run.end = i;
+    distinct = distinct && !visited[run.stripe];
+    visited[run.stripe] = true;
+    runs->push_back(run);
+  }
+  return distinct;
+}
+
+void StripedStorage::SliceKeys(const third_party::SArray<Key>& keys, std::vector<Slice>* slices) const {
+  std::vector<size_t> key_stripes(keys.size());
+  std::vector<size_t> sizes(stripes_.size(), 0);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    key_stripes[i] = StripeOf(keys[i]);
+    ++sizes[key_stripes[i]];
+  }
+  slices->assign(stripes_.size(), Slice());
+  for (size_t stripe = 0; stripe < sizes.size(); ++stripe) {
+    (*slices)[stripe].keys.reserve(sizes[stripe]);
+    (*slices)[stripe].positions.reserve(sizes[stripe]);
+  }
+  for (size_t i = 0; i < keys.size(); ++i) {
+    auto& slice = (*slices)[key_stripes[i]];
+    slice.keys.push_back(keys[i]);
+    slice.positions.push_back(i);
+  }
+}
+
+third_party::SArray<char> StripedStorage::GatherVals(const Slice& slice, const third_party::SArray<char>& vals,
+                                                     size_t val_bytes) {
+  third_party::SArray<char> slice_vals(slice.keys.size() * val_bytes);
+  for (size_t i = 0; i < slice.positions.size(); ++i) {
+    memcpy(slice_vals.data() + i * val_bytes, vals.data() + slice.positions[i] * val_bytes, val_bytes);
+  }
+  return slice_vals;
+}
+
+void StripedStorage::ForEach(size_t num_tasks, size_t num_keys, const std::function<void(size_t)>& fn) {
+  if (num_keys < kMinParallelKeys) {
+    for (size_t i = 0; i < num_tasks; ++i) fn(i);
+  } else {
+    pool_.ParallelFor(num_tasks, fn);
+  }
+}
+
+void StripedStorage::Update(bool assign, const third_party::SArray<Key>& typed_keys,
+                            const third_party::SArray<char>& vals) {
+  if (typed_keys.empty()) return;
+  auto apply = [this, assign](size_t stripe, const third_party::SArray<Key>& keys,
+                              const third_party::SArray<char>& stripe_vals) {
+    if (assign) {
+      stripes_[stripe]->SubAssign(keys, stripe_vals);
+    } else {
+      stripes_[stripe]->SubAdd(keys, stripe_vals);
+    }
+  };
+  size_t val_bytes = vals.size() / typed_keys.size();
+  std::vector<Run> runs;
+  if (ranged_ && (CutRuns(typed_keys, &runs) || typed_keys.size() < kMinParallelKeys)) {
+    ForEach(runs.size(), typed_keys.size(), [&](size_t i) {
+      const auto& run = runs[i];
+      apply(run.stripe, typed_keys.segment(run.begin, run.end),
+            vals.segment(run.begin * val_bytes, run.end * val_bytes));
+    });
+    return;
+  }
+  std::vector<Slice> slices;
+  SliceKeys(typed_keys, &slices);
+  ForEach(slices.size(), typed_keys.size(), [&](size_t stripe) {
+    if (slices[stripe].keys.empty()) return;
+    apply(stripe, slices[stripe].keys, GatherVals(slices[stripe], vals, val_bytes));
+  });
+}
+
+void StripedStorage::SubAdd(const third_party::SArray<Key>& typed_keys, const third_party::SArray<char>& vals) {
+  Update(false, typed_keys, vals);
+}
+
+void StripedStorage::SubAssign(const third_party::SArray<Key>& typed_keys, const third_party::SArray<char>& vals) {
+  Update(true, typed_keys, vals);
+}
+
+third_party::SArray<char> StripedStorage::SubGet(const third_party::SArray<Key>& typed_keys) {
+  if (typed_keys.empty()) return third_party::SArray<char>();
+  std::vector<Run> runs;
+  if (ranged_ && (CutRuns(typed_keys, &runs) || typed_keys.size() < kMinParallelKeys)) {
+    if (runs.size() == 1) return stripes_[runs[0].stripe]->SubGet(typed_keys);
+    std::vector<third_party::SArray<char>> run_vals(runs.size());
+    ForEach(runs.size(), typed_keys.size(), [&](size_t i) {
+      run_vals[i] = stripes_[runs[i].stripe]->SubGet(typed_keys.segment(runs[i].begin, runs[i].end));
+    });
+    // the runs are in the order of the request
+    size_t num_bytes = 0;
+    for (const auto& vals : run_vals) num_bytes += vals.size();
+    third_party::SArray<char> reply_vals;
+    reply_vals.reserve(num_bytes);
+    for (const auto& vals : run_vals) reply_vals.append(vals);
+    return reply_vals;
+  }
+  std::vector<Slice> slices;
+  SliceKeys(typed_keys, &slices);
+  std::vector<third_party::SArray<char>> slice_vals(stripes_.size());
+  ForEach(slices.size(), typed_keys.size(), [&](size_t stripe) {
+    if (!slices[stripe].keys.empty()) slice_vals[stripe] = stripes_[stripe]->SubGet(slices[stripe].keys);
+  });
+  // scatter the values of the stripes back into the order of the request
+  size_t val_bytes = 0;
+  for (size_t i = 0; i < slices.size(); ++i) {
+    if (!slices[i].keys.empty()) val_bytes = slice_vals[i].size() / slices[i].keys.size();
+  }
+  third_party::SArray<char> reply_vals(typed_keys.size() * val_bytes);
+  for (size_t stripe = 0; stripe < slices.size(); ++stripe) {
+    auto& positions = slices[stripe].positions;
+    for (size_t i = 0; i < positions.size(); ++i) {
+      memcpy(reply_vals.data() + positions[i] * val_bytes, slice_vals[stripe].data() + i * val_bytes, val_bytes);
+    }
+  }
+  return reply_vals;
+}
+
+std::unique_ptr<AbstractStorage> StripedStorage::CreateDelta() const {
+  // all stripes share the update mode and row width, merging the delta goes through SubAdd
+  return stripes_[0]->CreateDelta();
+}
+
+void StripedStorage::FinishIter() {
+  // the storages of the stripes do not work on FinishIter, checkpointing wraps the striped storage
+  for (auto& stripe : stripes_) stripe->FinishIter();
+}
+
+}  // namespace csci5570
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "base/message.hpp"
+#include "base/third_party/range.h"
+#include "server/abstract_storage.hpp"
+#include "server/util/thread_pool.hpp"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace csci5570 {
+
+/**
+ * Splits the storage of one shard into stripes to serve each request with several threads
+ *
+ * Each stripe is an ordinary storage holding a disjoint part of the keys of the shard, either a contiguous
+ * sub-range of the key range of the shard or the keys hashed to it. This is parallelism inside one request:
+ * requests reach the storage one at a time from the server thread, so the stripes need no locks.
+ *
+ * Requests with fewer than kMinParallelKeys keys are applied on the server thread, larger ones on a thread pool,
+ * one task per stripe. With ranged stripes a request is cut into runs of consecutive keys in the same stripe,
+ * which are zero-copy segments of the request, e.g. one run per stripe for the sorted keys that KVClientTable
+ * sends. Only a large request that visits a stripe in several runs is sliced by stripe, with its values gathered
+ * and its reply scattered. Sorted keys do not form runs in hashed stripes, so their requests are always sliced.
+ *
+ * The consistency model in front of the storage is unchanged, so progress tracking stays on the server thread.
+ */
+class StripedStorage : public AbstractStorage {
+ public:
+  /**
+   * Stripes over the sub-ranges SplitRange(range, stripes.size())
+   *
+   * @param stripes       the storages of the stripes, stripes[i] holding the i-th sub-range
+   * @param range         the key range of the shard
+   * @param num_threads   the threads applying a request, including the server thread
+   */
+  StripedStorage(std::vector<std::unique_ptr<AbstractStorage>>&& stripes, const third_party::Range& range,
+                 size_t num_threads);
+
+  /**
+   * Stripes by hashing keys
+   *
+   * @param stripes       the storages of the stripes
+   * @param num_threads   the threads applying a request, including the server thread
+   */
+  StripedStorage(std::vector<std::unique_ptr<AbstractStorage>>&& stripes, size_t num_threads);
+
+  virtual void SubAdd(const third_party::SArray<Key>& typed_keys, const third_party::SArray<char>& vals) override;
+  virtual third_party::SArray<char> SubGet(const third_party::SArray<Key>& typed_keys) override;
+  virtual void SubAssign(const third_party::SArray<Key>& typed_keys, const third_party::SArray<char>& vals) override;
+  virtual std::unique_ptr<AbstractStorage> CreateDelta() const override;
+  virtual void FinishIter() override;
+
+  size_t GetNumStripes() const { return stripes_.size(); }
+
+  // split range into num_stripes contiguous sub-ranges whose sizes differ by at most one
+  static std::vector<third_party::Range> SplitRange(const third_party::Range& range, size_t num_stripes);
+
+  // requests with fewer keys are not worth waking up the pool
+  static const size_t kMinParallelKeys = 1024;
+
+ private:
+  // the positions [begin, end) of consecutive keys of a request that fall into one stripe
+  struct Run {
+    size_t begin;
+    size_t end;
+    size_t stripe;
+  };
+  // the keys of a request that fall into one stripe, and their positions in the request
+  struct Slice {
+    third_party::SArray<Key> keys;
+    std::vector<size_t> positions;
+  };
+
+  size_t StripeOf(Key key) const;
+  // cut keys into maximal runs of ranged stripes, returns whether each stripe has at most one run
+  bool CutRuns(const third_party::SArray<Key>& keys, std::vector<Run>* runs) const;
+  void SliceKeys(const third_party::SArray<Key>& keys, std::vector<Slice>* slices) const;
+  // gather the values of a slice, val_bytes per key
+  static third_party::SArray<char> GatherVals(const Slice& slice, const third_party::SArray<char>& vals,
+                                              size_t val_bytes);
+  // call fn(i) for i in [0, num_tasks), on the pool if the request has enough keys
+  void ForEach(size_t num_tasks, size_t num_keys, const std::function<void(size_t)>& fn);
+  void Update(bool assign, const third_party::SArray<Key>& typed_keys, const third_party::SArray<char>& vals);
+
+  std::vector<std::unique_ptr<AbstractStorage>> stripes_;
+  bool ranged_;
+  third_party::Range range_;
+  std::vector<third_party::Range> stripe_ranges_;  // SplitRange(range_, stripes_.size()) if ranged_
+  ThreadPool pool_;
+};
+
+}  // namespace csci5570
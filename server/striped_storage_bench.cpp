@@ -0,0 +1,86 @@
+/**
+ * Add and Get throughput of one shard striped over K threads
+ *
+ * Each request has sorted random keys of the shard, as KVClientTable sends them. K = 1 is the storage of the
+ * shard without striping. Requests below StripedStorage::kMinParallelKeys keys run on the calling thread, so
+ * they show the overhead of striping, and larger ones show the scaling with K.
+ *
+ * Usage: StripedStorageBench [num_keys_of_shard] [row_width]
+ */
+#include "server/hash_storage.hpp"
+#include "server/striped_storage.hpp"
+#include "server/vector_storage.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace csci5570 {
+namespace {
+
+std::unique_ptr<AbstractStorage> CreateStorage(bool ranged, const third_party::Range& range, size_t num_threads,
+                                               size_t row_width) {
+  auto create_stripe = [&](const third_party::Range& r) {
+    if (ranged) return std::unique_ptr<AbstractStorage>(new VectorStorage<float>(r, UpdateMode::Accumulate, row_width));
+    return std::unique_ptr<AbstractStorage>(new HashStorage<float>(r.size(), UpdateMode::Accumulate, row_width));
+  };
+  if (num_threads == 1) return create_stripe(range);
+  std::vector<std::unique_ptr<AbstractStorage>> stripes;
+  if (ranged) {
+    for (auto& r : StripedStorage::SplitRange(range, num_threads)) stripes.push_back(create_stripe(r));
+    return std::unique_ptr<AbstractStorage>(new StripedStorage(std::move(stripes), range, num_threads));
+  }
+  for (size_t i = 0; i < num_threads; ++i) {
+    stripes.push_back(create_stripe(third_party::Range(0, range.size() / num_threads)));
+  }
+  return std::unique_ptr<AbstractStorage>(new StripedStorage(std::move(stripes), num_threads));
+}
+
+// returns keys per second of one Add and one Get per request
+double Run(AbstractStorage* storage, const std::vector<third_party::SArray<Key>>& requests, size_t row_width) {
+  size_t num_keys = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (auto& keys : requests) {
+    third_party::SArray<float> vals(keys.size() * row_width, 1);
+    storage->SubAdd(keys, third_party::SArray<char>(vals));
+    auto ret = storage->SubGet(keys);
+    if (ret.size() != vals.size() * sizeof(float)) fprintf(stderr, "unexpected reply size %zu\n", ret.size());
+    num_keys += keys.size();
+  }
+  std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+  return num_keys / seconds.count();
+}
+
+}  // namespace
+}  // namespace csci5570
+
+int main(int argc, char** argv) {
+  size_t shard_size = argc > 1 ? atol(argv[1]) : 1 << 22;
+  size_t row_width = argc > 2 ? atol(argv[2]) : 8;
+  csci5570::third_party::Range range(0, shard_size);
+  std::mt19937_64 rng(0);
+  printf("%8s %10s %8s %16s\n", "storage", "keys/req", "threads", "keys/s");
+  for (bool ranged : {true, false}) {
+    for (size_t request_size : {size_t(256), size_t(1) << 16, size_t(1) << 20}) {
+      // the same amount of keys for every request size
+      std::vector<csci5570::third_party::SArray<csci5570::Key>> requests(std::max<size_t>(1, (1 << 23) / request_size));
+      for (auto& keys : requests) {
+        std::vector<csci5570::Key> sorted(request_size);
+        for (auto& key : sorted) key = rng() % shard_size;
+        std::sort(sorted.begin(), sorted.end());
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+        keys = csci5570::third_party::SArray<csci5570::Key>(sorted);
+      }
+      for (size_t num_threads : {1, 2, 4, 8}) {
+        auto storage = csci5570::CreateStorage(ranged, range, num_threads, row_width);
+        double rate = csci5570::Run(storage.get(), requests, row_width);
+        printf("%8s %10zu %8zu %16.0f\n", ranged ? "Vector" : "Hash", request_size, num_threads, rate);
+      }
+    }
+  }
+  return 0;
+}
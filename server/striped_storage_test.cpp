@@ -0,0 +1,118 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/hash_storage.hpp"
+#include "server/striped_storage.hpp"
+#include "server/vector_storage.hpp"
+
+#include <vector>
+
+namespace csci5570 {
+namespace {
+
+class TestStripedStorage : public testing::Test {
+ public:
+  TestStripedStorage() {}
+  ~TestStripedStorage() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+TEST_F(TestStripedStorage, SplitRange) {
+  auto ranges = StripedStorage::SplitRange(third_party::Range(10, 20), 3);
+  ASSERT_EQ(ranges.size(), 3);
+  EXPECT_EQ(ranges[0].begin(), 10);
+  EXPECT_EQ(ranges[0].end(), 13);
+  EXPECT_EQ(ranges[1].end(), 16);
+  EXPECT_EQ(ranges[2].end(), 20);
+}
+
+TEST_F(TestStripedStorage, Ranged) {
+  third_party::Range range(100, 5100);
+  auto ranges = StripedStorage::SplitRange(range, 3);
+  std::vector<std::unique_ptr<AbstractStorage>> stripes;
+  for (auto& r : ranges) stripes.emplace_back(new VectorStorage<int>(r, UpdateMode::Accumulate, 2));
+  StripedStorage s(std::move(stripes), range, 3);
+
+  // every key of the range, in reverse, in one large request
+  third_party::SArray<Key> keys;
+  third_party::SArray<int> vals;
+  for (Key k = range.end(); k-- > range.begin();) {
+    keys.push_back(k);
+    vals.push_back(k);
+    vals.push_back(-k);
+  }
+  s.SubAdd(keys, third_party::SArray<char>(vals));
+  s.SubAdd(keys, third_party::SArray<char>(vals));
+
+  auto ret = third_party::SArray<int>(s.SubGet(keys));
+  ASSERT_EQ(ret.size(), vals.size());
+  for (size_t i = 0; i < vals.size(); ++i) EXPECT_EQ(ret[i], 2 * vals[i]);
+
+  // keys of a single stripe, and of the stripe borders
+  auto ret2 = third_party::SArray<int>(
+      s.SubGet(third_party::SArray<Key>({Key(ranges[1].begin()), Key(ranges[0].end() - 1), Key(range.end() - 1)})));
+  ASSERT_EQ(ret2.size(), 6);
+  EXPECT_EQ(ret2[0], 2 * ranges[1].begin());
+  EXPECT_EQ(ret2[2], 2 * (ranges[0].end() - 1));
+  EXPECT_EQ(ret2[4], 2 * (range.end() - 1));
+}
+
+TEST_F(TestStripedStorage, RangedInterleaved) {
+  third_party::Range range(0, 4000);
+  auto ranges = StripedStorage::SplitRange(range, 2);
+  std::vector<std::unique_ptr<AbstractStorage>> stripes;
+  for (auto& r : ranges) stripes.emplace_back(new VectorStorage<int>(r, UpdateMode::Assign));
+  StripedStorage s(std::move(stripes), range, 2);
+
+  // a large request alternating between the stripes is sliced, a small one is applied run by run
+  for (size_t num_keys : {size_t(2000), size_t(10)}) {
+    third_party::SArray<Key> keys;
+    third_party::SArray<int> vals;
+    for (Key k = 0; k < num_keys; ++k) {
+      keys.push_back(k % 2 == 0 ? k : range.end() - k);
+      vals.push_back(num_keys + k);
+    }
+    s.SubAssign(keys, third_party::SArray<char>(vals));
+    auto ret = third_party::SArray<int>(s.SubGet(keys));
+    ASSERT_EQ(ret.size(), keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) EXPECT_EQ(ret[i], vals[i]);
+  }
+}
+
+TEST_F(TestStripedStorage, HashedParallel) {
+  std::vector<std::unique_ptr<AbstractStorage>> stripes;
+  for (int i = 0; i < 4; ++i) stripes.emplace_back(new HashStorage<int>(0, UpdateMode::Accumulate));
+  StripedStorage s(std::move(stripes), 4);
+
+  // enough keys for the slices of each request to be applied on the pool
+  third_party::SArray<Key> keys;
+  for (Key k = 0; k < 3000; ++k) keys.push_back(k * 7);
+  ASSERT_GE(keys.size(), StripedStorage::kMinParallelKeys);
+  third_party::SArray<int> vals(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) vals[i] = i;
+  for (int i = 0; i < 10; ++i) s.SubAdd(keys, third_party::SArray<char>(vals));
+
+  auto ret = third_party::SArray<int>(s.SubGet(keys));
+  ASSERT_EQ(ret.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) EXPECT_EQ(ret[i], static_cast<int>(10 * i));
+}
+
+TEST_F(TestStripedStorage, MergeDelta) {
+  std::vector<std::unique_ptr<AbstractStorage>> stripes;
+  for (int i = 0; i < 2; ++i) stripes.emplace_back(new HashStorage<int>(0, UpdateMode::Accumulate));
+  StripedStorage s(std::move(stripes), 2);
+  auto delta = s.CreateDelta();
+  third_party::SArray<int> vals({1, 2, 3});
+  delta->SubAdd(third_party::SArray<Key>({Key(1), Key(2), Key(1)}), third_party::SArray<char>(vals));
+  s.MergeDelta(*delta);
+  auto ret = third_party::SArray<int>(s.SubGet(third_party::SArray<Key>({Key(1), Key(2)})));
+  ASSERT_EQ(ret.size(), 2);
+  EXPECT_EQ(ret[0], 4);
+  EXPECT_EQ(ret[1], 2);
+}
+
+}  // namespace
+}  // namespace csci5570
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "base/magic.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace csci5570 {
+
+enum class InitializerType { Zero, Constant, Uniform, Normal };
+
+/**
+ * The value of keys that have not been written yet
+ */
+struct InitializerConfig {
+  InitializerType type = InitializerType::Zero;
+  double value = 0;   // Constant
+  double low = 0;     // Uniform in [low, high)
+  double high = 1;
+  double mean = 0;    // Normal
+  double stddev = 1;
+  uint64_t seed = 0;  // Uniform and Normal
+};
+
+/**
+ * Computes the initial values of keys on demand
+ *
+ * Random values are a function of (seed, key, column), so every server thread and every read of an unseen key
+ * agree on them without storing anything.
+ */
+class Initializer {
+ public:
+  explicit Initializer(const InitializerConfig& config = InitializerConfig()) : config_(config) {}
+
+  bool IsZero() const {
+    return config_.type == InitializerType::Zero ||
+           (config_.type == InitializerType::Constant && config_.value == 0);
+  }
+
+  // the initial value of column <column> of the row of <key>
+  double Value(Key key, size_t column) const {
+    switch (config_.type) {
+      case InitializerType::Constant:
+        return config_.value;
+      case InitializerType::Uniform:
+        return config_.low + (config_.high - config_.low) * ToUnit(Hash(key, column));
+      case InitializerType::Normal: {
+        // Box-Muller over two independent hashes, 1 - u keeps the log finite
+        uint64_t h = Hash(key, column);
+        double u1 = 1.0 - ToUnit(h);
+        double u2 = ToUnit(Mix(h));
+        return config_.mean + config_.stddev * std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+      }
+      default:
+        return 0;
+    }
+  }
+
+  // fill the row of <key> with its initial values
+  template <typename Val>
+  void Fill(Key key, Val* row, size_t row_width) const {
+    if (IsZero()) {
+      for (size_t i = 0; i < row_width; ++i) row[i] = Val();
+    } else {
+      for (size_t i = 0; i < row_width; ++i) row[i] = static_cast<Val>(Value(key, i));
+    }
+  }
+
+  const InitializerConfig& GetConfig() const { return config_; }
+
+ private:
+  // splitmix64 finalizer
+  static uint64_t Mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  uint64_t Hash(Key key, size_t column) const {
+    return Mix(Mix(config_.seed) ^ ((static_cast<uint64_t>(key) << 32) | static_cast<uint32_t>(column)));
+  }
+
+  // uniform in [0, 1) from the top 53 bits
+  static double ToUnit(uint64_t h) { return (h >> 11) * (1.0 / 9007199254740992.0); }
+
+  InitializerConfig config_;
+};
+
+}  // namespace csci5570
@@ -0,0 +1,78 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/util/initializer.hpp"
+
+#include <cmath>
+
+namespace csci5570 {
+namespace {
+
+class TestInitializer : public testing::Test {
+ public:
+  TestInitializer() {}
+  ~TestInitializer() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+TEST_F(TestInitializer, Constant) {
+  InitializerConfig config;
+  config.type = InitializerType::Constant;
+  config.value = 1.5;
+  Initializer initializer(config);
+  EXPECT_FALSE(initializer.IsZero());
+  float row[3];
+  initializer.Fill(7, row, 3);
+  for (auto v : row) EXPECT_FLOAT_EQ(v, 1.5);
+  EXPECT_TRUE(Initializer().IsZero());
+}
+
+TEST_F(TestInitializer, Uniform) {
+  InitializerConfig config;
+  config.type = InitializerType::Uniform;
+  config.low = -0.5;
+  config.high = 0.5;
+  config.seed = 42;
+  Initializer initializer(config);
+  double sum = 0;
+  for (Key key = 0; key < 10000; ++key) {
+    double v = initializer.Value(key, 0);
+    EXPECT_GE(v, -0.5);
+    EXPECT_LT(v, 0.5);
+    EXPECT_EQ(v, initializer.Value(key, 0));  // deterministic
+    sum += v;
+  }
+  EXPECT_NEAR(sum / 10000, 0, 0.02);
+  EXPECT_NE(initializer.Value(1, 0), initializer.Value(1, 1));
+
+  config.seed = 43;
+  EXPECT_NE(Initializer(config).Value(1, 0), initializer.Value(1, 0));
+}
+
+TEST_F(TestInitializer, Normal) {
+  InitializerConfig config;
+  config.type = InitializerType::Normal;
+  config.mean = 1;
+  config.stddev = 2;
+  Initializer initializer(config);
+  const int n = 20000;
+  double row[4];
+  double sum = 0, sum_sq = 0;
+  for (Key key = 0; key < n / 4; ++key) {
+    initializer.Fill(key, row, 4);
+    for (auto v : row) {
+      ASSERT_TRUE(std::isfinite(v));
+      sum += v;
+      sum_sq += v * v;
+    }
+  }
+  double mean = sum / n;
+  EXPECT_NEAR(mean, 1, 0.05);
+  EXPECT_NEAR(std::sqrt(sum_sq / n - mean * mean), 2, 0.05);
+}
+
+}  // namespace
+}  // namespace csci5570
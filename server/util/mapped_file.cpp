@@ -0,0 +1,60 @@
+#include "server/util/mapped_file.hpp"
+
+#include "glog/logging.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+namespace csci5570 {
+
+MappedFile::MappedFile(const std::string& path, size_t size) : path_(path) {
+  fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  PCHECK(fd_ >= 0) << "cannot open " << path;
+  Map(size);
+}
+
+MappedFile::~MappedFile() {
+  Unmap();
+  if (fd_ >= 0) close(fd_);
+}
+
+void MappedFile::Resize(size_t size) {
+  Unmap();
+  Map(size);
+}
+
+void MappedFile::Advise(size_t offset, size_t length, int advice) {
+  if (length == 0 || offset >= size_) return;
+  size_t page = PageSize();
+  size_t begin = offset / page * page;
+  size_t end = std::min(offset + length, mapped_size_);
+  madvise(data_ + begin, end - begin, advice);  // only a hint, failures are harmless
+}
+
+size_t MappedFile::PageSize() {
+  static const size_t page_size = sysconf(_SC_PAGESIZE);
+  return page_size;
+}
+
+void MappedFile::Map(size_t size) {
+  size_t page = PageSize();
+  size_t mapped_size = std::max((size + page - 1) / page * page, page);
+  PCHECK(ftruncate(fd_, mapped_size) == 0) << "cannot resize " << path_;
+  void* data = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  PCHECK(data != MAP_FAILED) << "cannot map " << path_;
+  data_ = static_cast<char*>(data);
+  size_ = size;
+  mapped_size_ = mapped_size;
+}
+
+void MappedFile::Unmap() {
+  if (data_ == nullptr) return;
+  munmap(data_, mapped_size_);
+  data_ = nullptr;
+  size_ = mapped_size_ = 0;
+}
+
+}  // namespace csci5570
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace csci5570 {
+
+/**
+ * A file mapped into memory with read/write access
+ *
+ * The mapping is shared, so the OS page cache decides which parts of the file stay in RAM
+ * and writes back dirty pages under memory pressure. New bytes read as zero.
+ */
+class MappedFile {
+ public:
+  /**
+   * Create (or truncate) the file at path and map its first size bytes
+   */
+  MappedFile(const std::string& path, size_t size);
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * Grow or shrink the file and the mapping, keeping the content up to the smaller size
+   * Pointers into the old mapping are invalidated
+   */
+  void Resize(size_t size);
+
+  /**
+   * Give the kernel an madvise hint about bytes [offset, offset + length), rounded out to whole pages
+   */
+  void Advise(size_t offset, size_t length, int advice);
+
+  char* data() const { return data_; }
+  size_t size() const { return size_; }
+  const std::string& path() const { return path_; }
+
+  static size_t PageSize();
+
+ private:
+  void Map(size_t size);
+  void Unmap();
+
+  std::string path_;
+  int fd_ = -1;
+  char* data_ = nullptr;
+  size_t size_ = 0;
+  size_t mapped_size_ = 0;  // mmap does not accept 0 bytes, so at least one page is mapped
+};
+
+}  // namespace csci5570
@@ -0,0 +1,49 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/util/mapped_file.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace csci5570 {
+namespace {
+
+class TestMappedFile : public testing::Test {
+ public:
+  TestMappedFile() {}
+  ~TestMappedFile() {}
+
+ protected:
+  void SetUp() { path_ = "/tmp/csci5570_mapped_file_test_" + std::to_string(getpid()); }
+  void TearDown() { std::remove(path_.c_str()); }
+
+  std::string path_;
+};
+
+TEST_F(TestMappedFile, ZeroInitialized) {
+  MappedFile file(path_, 100);
+  EXPECT_EQ(file.size(), 100);
+  for (size_t i = 0; i < file.size(); ++i) EXPECT_EQ(file.data()[i], 0);
+}
+
+TEST_F(TestMappedFile, ResizeKeepsContent) {
+  MappedFile file(path_, 0);
+  EXPECT_EQ(file.size(), 0);
+  file.Resize(16);
+  memcpy(file.data(), "0123456789abcdef", 16);
+
+  size_t size = 3 * MappedFile::PageSize() + 5;
+  file.Resize(size);
+  ASSERT_EQ(file.size(), size);
+  EXPECT_EQ(memcmp(file.data(), "0123456789abcdef", 16), 0);
+  EXPECT_EQ(file.data()[size - 1], 0);
+  file.Advise(0, size, MADV_WILLNEED);
+}
+
+}  // namespace
+}  // namespace csci5570
@@ -1,22 +1,59 @@
 #include "server/util/pending_buffer.hpp"
 
+#include "glog/logging.h"
+
+#include <algorithm>
+
 namespace csci5570 {
 
-// if clock not exist, return an empty vector
-std::vector<Message> PendingBuffer::Pop(const int clock) {
-  auto it = buffer_map.find(clock);
-  auto rslt = it != buffer_map.end() ? it->second : std::vector<Message>();
-  buffer_map.erase(it);
-  return rslt;
+PendingBuffer::PendingBuffer(int num_buckets) : buckets_(num_buckets) { CHECK_GT(num_buckets, 0); }
+
+void PendingBuffer::PopUpTo(const int clock, std::vector<Message>* msgs) {
+  if (size_ == 0) return;
+  std::vector<Bucket*> released;
+  for (auto& bucket : buckets_) {
+    if (!bucket.msgs.empty() && bucket.clock <= clock) released.push_back(&bucket);
+  }
+  std::sort(released.begin(), released.end(), [](Bucket* a, Bucket* b) { return a->clock < b->clock; });
+  for (auto* bucket : released) {
+    for (auto& msg : bucket->msgs) msgs->push_back(std::move(msg));
+    size_ -= bucket->msgs.size();
+    bucket->msgs.clear();  // keeps the capacity for the clocks to come
+  }
+}
+
+void PendingBuffer::Push(const int clock, Message&& msg) {
+  CHECK_GE(clock, 0);
+  auto* bucket = &buckets_[clock % buckets_.size()];
+  if (!bucket->msgs.empty() && bucket->clock != clock) {
+    Grow(clock);
+    bucket = &buckets_[clock % buckets_.size()];
+  }
+  bucket->clock = clock;
+  bucket->msgs.push_back(std::move(msg));
+  ++size_;
 }
 
-void PendingBuffer::Push(const int clock, Message& msg) {
-  buffer_map[clock].push_back(msg);
+int PendingBuffer::Size(const int progress) const {
+  auto& bucket = buckets_[progress % buckets_.size()];
+  return bucket.clock == progress ? bucket.msgs.size() : 0;
 }
 
-int PendingBuffer::Size(const int progress) {
-  auto it = buffer_map.find(progress);
-  return it != buffer_map.end() ? it->second.size() : 0;
+void PendingBuffer::Grow(const int clock) {
+  int min_clock = clock;
+  int max_clock = clock;
+  for (auto& bucket : buckets_) {
+    if (bucket.msgs.empty()) continue;
+    min_clock = std::min(min_clock, bucket.clock);
+    max_clock = std::max(max_clock, bucket.clock);
+  }
+  // any window of as many consecutive clocks as buckets maps to distinct buckets
+  size_t num_buckets = std::max<size_t>(buckets_.size() * 2, max_clock - min_clock + 1);
+  std::vector<Bucket> buckets(num_buckets);
+  for (auto& bucket : buckets_) {
+    if (!bucket.msgs.empty()) buckets[bucket.clock % num_buckets] = std::move(bucket);
+  }
+  buckets_ = std::move(buckets);
 }
 
 }  // namespace csci5570
@@ -2,27 +2,48 @@
 
 #include "base/message.hpp"
 
-#include <unordered_map>
+#include <vector>
 
 namespace csci5570 {
 
+/**
+ * The requests waiting for the min clock to reach a clock
+ *
+ * A ring of buckets indexed by clock % (number of buckets), one clock per bucket. With SSP the clocks waited for
+ * lie within staleness + 1 of each other, so the ring keeps that many buckets and reuses them clock after clock.
+ * If a wider window of clocks shows up, the ring grows to cover it.
+ */
 class PendingBuffer {
  public:
+  explicit PendingBuffer(int num_buckets = 1);
   /**
-   * Return the pending requests at the specific progress clock
+   * Move out the pending requests of all clocks up to and including <clock>, in the order of their clocks
    */
-  virtual std::vector<Message> Pop(const int clock);
+  void PopUpTo(const int clock, std::vector<Message>* msgs);
   /**
-   * Add the pending requests at the specific progress clock
+   * Add a pending request at the specific progress clock
    */
-  virtual void Push(const int clock, Message& message);
+  void Push(const int clock, Message&& msg);
   /**
    * Return the number of pending requests at the specific progress
    */
-  virtual int Size(const int progress);
+  int Size(const int progress) const;
+  /**
+   * Return the number of pending requests
+   */
+  int Size() const { return size_; }
+
+ private:
+  struct Bucket {
+    int clock = 0;
+    std::vector<Message> msgs;
+  };
+
+  // make room for <clock> in a ring without collisions
+  void Grow(const int clock);
 
-  private:
-    std::map<int, std::vector<Message>> buffer_map;
+  std::vector<Bucket> buckets_;
+  int size_ = 0;
 };
 
 }  // namespace csci5570
@@ -43,18 +43,60 @@ TEST_F(TestPendingBuffer, PushAndPop) {
   m2.AddData(m1_keys);
   m2.AddData(m1_vals);
 
-  pending_buffer.Push(0, m1);
-  pending_buffer.Push(0, m1);
-  pending_buffer.Push(1, m2);
+  pending_buffer.Push(0, Message(m1));
+  pending_buffer.Push(0, Message(m1));
+  pending_buffer.Push(1, std::move(m2));
 
   EXPECT_EQ(pending_buffer.Size(0), 2);
   EXPECT_EQ(pending_buffer.Size(1), 1);
+  EXPECT_EQ(pending_buffer.Size(), 3);
 
-  std::vector<Message> messages_0 = pending_buffer.Pop(0);
-  std::vector<Message> messages_1 = pending_buffer.Pop(1);
+  std::vector<Message> messages_0;
+  pending_buffer.PopUpTo(0, &messages_0);
+  std::vector<Message> messages_1;
+  pending_buffer.PopUpTo(1, &messages_1);
 
   EXPECT_EQ(messages_0.size(), 2);
   EXPECT_EQ(messages_1.size(), 1);
+  EXPECT_EQ(pending_buffer.Size(), 0);
+}
+
+TEST_F(TestPendingBuffer, Ring) {
+  PendingBuffer pending_buffer(3);
+  for (int clock = 0; clock < 10; ++clock) {
+    Message msg;
+    msg.meta.sender = clock;
+    pending_buffer.Push(clock, std::move(msg));
+    EXPECT_EQ(pending_buffer.Size(clock), 1);
+    std::vector<Message> msgs;
+    pending_buffer.PopUpTo(clock - 2, &msgs);
+    if (clock >= 2) {
+      ASSERT_EQ(msgs.size(), 1);
+      EXPECT_EQ(msgs[0].meta.sender, clock - 2);
+    }
+  }
+  EXPECT_EQ(pending_buffer.Size(), 2);
+  EXPECT_EQ(pending_buffer.Size(5), 0);
+}
+
+TEST_F(TestPendingBuffer, GrowAndSweep) {
+  PendingBuffer pending_buffer(2);
+  // clocks further apart than the ring, one sweep releases them in order
+  for (int clock : {7, 3, 4, 12, 3}) {
+    Message msg;
+    msg.meta.sender = clock;
+    pending_buffer.Push(clock, std::move(msg));
+  }
+  EXPECT_EQ(pending_buffer.Size(3), 2);
+  EXPECT_EQ(pending_buffer.Size(12), 1);
+  std::vector<Message> msgs;
+  pending_buffer.PopUpTo(7, &msgs);
+  ASSERT_EQ(msgs.size(), 4);
+  EXPECT_EQ(msgs[0].meta.sender, 3);
+  EXPECT_EQ(msgs[1].meta.sender, 3);
+  EXPECT_EQ(msgs[2].meta.sender, 4);
+  EXPECT_EQ(msgs[3].meta.sender, 7);
+  EXPECT_EQ(pending_buffer.Size(), 1);
 }
 
 }  // namespace
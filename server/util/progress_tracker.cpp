@@ -2,33 +2,69 @@
 
 #include "glog/logging.h"
 
+#include <algorithm>
+
 namespace csci5570 {
 
+const int ProgressTracker::kNotTracked;
+
 void ProgressTracker::Init(const std::vector<uint32_t>& tids) {
-  for (auto tid : tids) {
-    progresses_[tid] = 0;
+  // workers tracked before stay, the given ones start over from 0
+  std::vector<std::pair<int, int>> tracked;  // {tid: progress}, later entries win
+  for (int i = 0; i < progresses_.size(); ++i) {
+    if (progresses_[i] != kNotTracked) tracked.push_back({base_tid_ + i, progresses_[i]});
   }
+  for (auto tid : tids) tracked.push_back({static_cast<int>(tid), 0});
+
+  progresses_.clear();
+  clock_counts_.clear();
+  num_threads_ = 0;
   min_clock_ = 0;
+  if (tracked.empty()) return;
+  auto minmax = std::minmax_element(tracked.begin(), tracked.end());
+  base_tid_ = minmax.first->first;
+  progresses_.assign(minmax.second->first - base_tid_ + 1, kNotTracked);
+  for (auto& pair : tracked) {
+    int& progress = progresses_[pair.first - base_tid_];
+    if (progress == kNotTracked) ++num_threads_;
+    progress = pair.second;
+  }
+  for (auto progress : progresses_) {
+    if (progress == kNotTracked) continue;
+    if (progress >= clock_counts_.size()) clock_counts_.resize(progress + 1, 0);
+    ++clock_counts_[progress];
+  }
+}
+
+void ProgressTracker::InitGroup(uint32_t group, const std::vector<uint32_t>& members) {
+  Init({group});
+  for (auto member : members) group_of_[member] = group;
 }
 
 int ProgressTracker::AdvanceAndGetChangedMinClock(int tid) {
-  int rst;
-  if (IsUniqueMin(tid)) {
-    min_clock_++;
-    rst = min_clock_;
-  } else {
-    rst = -1;
+  CHECK(IsTracked(tid)) << "worker " << tid << " is not tracked";
+  int& progress = progresses_[tid - base_tid_];
+  size_t offset = progress - min_clock_;
+  if (offset + 1 == clock_counts_.size()) clock_counts_.push_back(0);
+  --clock_counts_[offset];
+  ++clock_counts_[offset + 1];
+  ++progress;
+  // the min clock moves when its last worker leaves it, and only by one since that worker is now right above it
+  if (offset == 0 && clock_counts_[0] == 0) {
+    clock_counts_.pop_front();
+    return ++min_clock_;
   }
-  progresses_[tid]++;
-  return rst;
+  return -1;
 }
 
 int ProgressTracker::GetNumThreads() const {
-  return progresses_.size();
+  return num_threads_;
 }
 
 int ProgressTracker::GetProgress(int tid) const {
-  return CheckThreadValid(tid) ? progresses_.at(tid) : -1;
+  if (IsTracked(tid)) return progresses_[tid - base_tid_];
+  auto it = group_of_.find(tid);
+  return it != group_of_.end() ? progresses_[it->second - base_tid_] : -1;
 }
 
 int ProgressTracker::GetMinClock() const {
@@ -36,17 +72,16 @@ int ProgressTracker::GetMinClock() const {
 }
 
 bool ProgressTracker::IsUniqueMin(int tid) const {
-  if (GetProgress(tid) != min_clock_) return false;
-  for (auto pair : progresses_) {
-    if (pair.second == min_clock_ && pair.first != tid) {
-      return false;
-    }
-  }
-  return true;
+  return GetProgress(tid) == min_clock_ && clock_counts_[0] == 1;
 }
 
 bool ProgressTracker::CheckThreadValid(int tid) const {
-  return progresses_.find(tid) != progresses_.end();
+  return IsTracked(tid) || group_of_.find(tid) != group_of_.end();
+}
+
+bool ProgressTracker::IsTracked(int tid) const {
+  return tid >= base_tid_ && tid - base_tid_ < static_cast<int>(progresses_.size()) &&
+         progresses_[tid - base_tid_] != kNotTracked;
 }
 
 }  // namespace csci5570
@@ -1,13 +1,31 @@
 #pragma once
 
-#include <map>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
 #include <vector>
 
 namespace csci5570 {
 
+/**
+ * The clocks of the worker threads of a model
+ *
+ * Progresses live in an array indexed by tid, offset by the smallest tid, and the number of workers at each
+ * clock from the min clock up is counted, so advancing a worker and moving the min clock are O(1).
+ *
+ * Worker threads may also be tracked as a group that clocks as one, e.g. all the workers of a node. The group
+ * then stands for its members: they are valid, and their progress is the progress of the group.
+ */
 class ProgressTracker {
  public:
   void Init(const std::vector<uint32_t>& tids);
+  /**
+   * Track the members through a group that clocks on their behalf
+   *
+   * @param group     the id of the group, used as the tid of its clocks
+   * @param members   the worker threads in the group
+   */
+  void InitGroup(uint32_t group, const std::vector<uint32_t>& members);
   /**
    * Advance the progress of a worker thread
    * Return -1 if min_clock_ does not change,
@@ -44,8 +62,17 @@ class ProgressTracker {
   bool CheckThreadValid(int tid) const;
 
  private:
-  std::map<int, int> progresses_;  // {tid: progress}
-  int min_clock_;                  // the slowest progress
+  static const int kNotTracked = -1;
+
+  // whether tid clocks by itself, as a worker thread or a group
+  bool IsTracked(int tid) const;
+
+  std::vector<int> progresses_;     // progresses_[tid - base_tid_] is the progress of tid, or kNotTracked
+  int base_tid_ = 0;
+  int num_threads_ = 0;
+  std::deque<int> clock_counts_;    // clock_counts_[i] is the number of workers at clock min_clock_ + i
+  int min_clock_ = 0;               // the slowest progress
+  std::unordered_map<int, int> group_of_;  // member tid -> group tid
 };
 
 }  // namespace csci5570
@@ -0,0 +1,82 @@
+/**
+ * Clock throughput of ProgressTracker with many workers
+ *
+ * Every round each worker clocks once in a random order, as the Clock messages of a shard arrive under BSP/SSP.
+ * The scan tracker below is the previous implementation, which looked at every worker on each Clock.
+ *
+ * Usage: ProgressTrackerBench [rounds]
+ */
+#include "server/util/progress_tracker.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace csci5570 {
+namespace {
+
+class ScanProgressTracker {
+ public:
+  void Init(const std::vector<uint32_t>& tids) {
+    for (auto tid : tids) progresses_[tid] = 0;
+    min_clock_ = 0;
+  }
+  int AdvanceAndGetChangedMinClock(int tid) {
+    int rst = -1;
+    if (IsUniqueMin(tid)) rst = ++min_clock_;
+    progresses_[tid]++;
+    return rst;
+  }
+
+ private:
+  bool IsUniqueMin(int tid) const {
+    if (progresses_.at(tid) != min_clock_) return false;
+    for (auto pair : progresses_) {
+      if (pair.second == min_clock_ && pair.first != tid) return false;
+    }
+    return true;
+  }
+
+  std::map<int, int> progresses_;
+  int min_clock_ = 0;
+};
+
+// returns clocks per second
+template <typename Tracker>
+double Run(const std::vector<uint32_t>& tids, const std::vector<std::vector<uint32_t>>& orders) {
+  Tracker tracker;
+  tracker.Init(tids);
+  int num_changes = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (auto& order : orders) {
+    for (auto tid : order) num_changes += tracker.AdvanceAndGetChangedMinClock(tid) != -1;
+  }
+  std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+  if (num_changes != orders.size()) fprintf(stderr, "unexpected min clock changes: %d\n", num_changes);
+  return tids.size() * orders.size() / seconds.count();
+}
+
+}  // namespace
+}  // namespace csci5570
+
+int main(int argc, char** argv) {
+  int rounds = argc > 1 ? atoi(argv[1]) : 20;
+  std::mt19937 rng(0);
+  printf("%10s %18s %18s\n", "workers", "clocks/s", "scan clocks/s");
+  for (int num_workers : {1000, 2000, 5000, 10000}) {
+    // worker tids of 10 nodes, as the id mapper assigns them
+    std::vector<uint32_t> tids;
+    for (int i = 0; i < num_workers; ++i) tids.push_back((i % 10) * 1000 + i / 10);
+    std::vector<std::vector<uint32_t>> orders(rounds, tids);
+    for (auto& order : orders) std::shuffle(order.begin(), order.end(), rng);
+
+    double fast = csci5570::Run<csci5570::ProgressTracker>(tids, orders);
+    double scan = csci5570::Run<csci5570::ScanProgressTracker>(tids, orders);
+    printf("%10d %18.0f %18.0f\n", num_workers, fast, scan);
+  }
+  return 0;
+}
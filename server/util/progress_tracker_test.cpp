@@ -46,5 +46,65 @@ TEST_F(TestProgressTracker, Advance) {
   EXPECT_EQ(tracker.GetProgress(7), 3);
 }
 
+TEST_F(TestProgressTracker, UniqueMin) {
+  ProgressTracker tracker;
+  tracker.Init({4, 5, 6});
+  EXPECT_FALSE(tracker.IsUniqueMin(4));
+  tracker.AdvanceAndGetChangedMinClock(4);
+  tracker.AdvanceAndGetChangedMinClock(5);
+  EXPECT_TRUE(tracker.IsUniqueMin(6));
+  EXPECT_FALSE(tracker.IsUniqueMin(4));
+  EXPECT_EQ(tracker.AdvanceAndGetChangedMinClock(6), 1);
+  EXPECT_FALSE(tracker.CheckThreadValid(3));
+  EXPECT_EQ(tracker.GetProgress(7), -1);
+}
+
+TEST_F(TestProgressTracker, ManyWorkers) {
+  const int kNumWorkers = 1000;
+  std::vector<uint32_t> tids;
+  for (int i = 0; i < kNumWorkers; ++i) tids.push_back(3000 + 2 * i);
+  ProgressTracker tracker;
+  tracker.Init(tids);
+  EXPECT_EQ(tracker.GetNumThreads(), kNumWorkers);
+  EXPECT_FALSE(tracker.CheckThreadValid(3001));
+  // the last worker is two clocks ahead, the others clock in turn
+  tracker.AdvanceAndGetChangedMinClock(tids.back());
+  tracker.AdvanceAndGetChangedMinClock(tids.back());
+  for (int clock = 1; clock <= 2; ++clock) {
+    for (int i = 0; i + 1 < kNumWorkers; ++i) {
+      int changed = tracker.AdvanceAndGetChangedMinClock(tids[i]);
+      EXPECT_EQ(changed, i + 2 == kNumWorkers ? clock : -1);
+    }
+  }
+  EXPECT_EQ(tracker.GetMinClock(), 2);
+  EXPECT_EQ(tracker.AdvanceAndGetChangedMinClock(tids.back()), -1);
+}
+
+TEST_F(TestProgressTracker, InitAgain) {
+  ProgressTracker tracker;
+  tracker.Init({2, 7});
+  tracker.AdvanceAndGetChangedMinClock(2);
+  tracker.Init({7, 9});
+  EXPECT_EQ(tracker.GetNumThreads(), 3);
+  EXPECT_EQ(tracker.GetProgress(2), 1);
+  EXPECT_EQ(tracker.GetProgress(9), 0);
+  EXPECT_EQ(tracker.AdvanceAndGetChangedMinClock(7), -1);
+  EXPECT_EQ(tracker.AdvanceAndGetChangedMinClock(9), 1);
+}
+
+TEST_F(TestProgressTracker, Group) {
+  ProgressTracker tracker;
+  tracker.InitGroup(1050, {1000, 1001});
+  tracker.InitGroup(2050, {2000});
+  EXPECT_EQ(tracker.GetNumThreads(), 2);
+  EXPECT_TRUE(tracker.CheckThreadValid(1001));
+  EXPECT_TRUE(tracker.CheckThreadValid(2050));
+  EXPECT_FALSE(tracker.CheckThreadValid(1002));
+  EXPECT_EQ(tracker.AdvanceAndGetChangedMinClock(1050), -1);
+  EXPECT_EQ(tracker.GetProgress(1000), 1);  // members report the progress of their group
+  EXPECT_EQ(tracker.GetProgress(2000), 0);
+  EXPECT_EQ(tracker.AdvanceAndGetChangedMinClock(2050), 1);
+}
+
 }  // namespace
 }  // namespace csci5570
@@ -0,0 +1,60 @@
+#include "server/util/thread_pool.hpp"
+
+#include "glog/logging.h"
+
+namespace csci5570 {
+
+ThreadPool::ThreadPool(size_t num_threads) {
+  CHECK_GT(num_threads, 0);
+  for (size_t i = 1; i < num_threads; ++i) threads_.emplace_back([this] { Work(); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    stop_ = true;
+  }
+  work_cond_.notify_all();
+  for (auto& thread : threads_) thread.join();
+}
+
+void ThreadPool::ParallelFor(size_t num_tasks, const std::function<void(size_t)>& fn) {
+  if (num_tasks == 0) return;
+  if (threads_.empty() || num_tasks == 1) {
+    for (size_t i = 0; i < num_tasks; ++i) fn(i);
+    return;
+  }
+  std::lock_guard<std::mutex> call_lk(call_mu_);
+  std::unique_lock<std::mutex> lk(mu_);
+  fn_ = &fn;
+  num_tasks_ = num_tasks;
+  next_task_ = 0;
+  num_done_ = 0;
+  work_cond_.notify_all();
+  RunTasks(&lk);
+  done_cond_.wait(lk, [this] { return num_done_ == num_tasks_; });
+  fn_ = nullptr;
+}
+
+void ThreadPool::Work() {
+  std::unique_lock<std::mutex> lk(mu_);
+  while (true) {
+    work_cond_.wait(lk, [this] { return stop_ || next_task_ < num_tasks_; });
+    if (stop_) return;
+    RunTasks(&lk);
+  }
+}
+
+void ThreadPool::RunTasks(std::unique_lock<std::mutex>* lk) {
+  // tasks are coarse, so taking the lock once per task is cheap enough
+  while (next_task_ < num_tasks_) {
+    size_t task = next_task_++;
+    auto* fn = fn_;
+    lk->unlock();
+    (*fn)(task);
+    lk->lock();
+    if (++num_done_ == num_tasks_) done_cond_.notify_all();
+  }
+}
+
+}  // namespace csci5570
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace csci5570 {
+
+/**
+ * A fixed group of threads that runs the tasks of one fork-join loop at a time
+ *
+ * The thread calling ParallelFor works on the tasks as well, so a pool of n threads starts n - 1 of its own.
+ */
+class ThreadPool {
+ public:
+  explicit ThreadPool(size_t num_threads);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * Call fn(i) for i in [0, num_tasks) on the threads of the pool and return when all calls are done
+   * Calls from different threads are served one after another
+   */
+  void ParallelFor(size_t num_tasks, const std::function<void(size_t)>& fn);
+
+  size_t GetNumThreads() const { return threads_.size() + 1; }
+
+ private:
+  void Work();
+  // run tasks of the current loop until none is left, with mu_ held
+  void RunTasks(std::unique_lock<std::mutex>* lk);
+
+  std::vector<std::thread> threads_;
+  std::mutex call_mu_;  // one loop at a time
+  std::mutex mu_;
+  std::condition_variable work_cond_;
+  std::condition_variable done_cond_;
+  const std::function<void(size_t)>* fn_ = nullptr;
+  size_t num_tasks_ = 0;
+  size_t next_task_ = 0;
+  size_t num_done_ = 0;
+  bool stop_ = false;
+};
+
+}  // namespace csci5570
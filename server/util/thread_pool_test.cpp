@@ -0,0 +1,42 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/util/thread_pool.hpp"
+
+#include <atomic>
+#include <vector>
+
+namespace csci5570 {
+namespace {
+
+class TestThreadPool : public testing::Test {
+ public:
+  TestThreadPool() {}
+  ~TestThreadPool() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+TEST_F(TestThreadPool, ParallelFor) {
+  ThreadPool pool(4);
+  EXPECT_EQ(pool.GetNumThreads(), 4);
+  for (int round = 0; round < 100; ++round) {
+    std::vector<int> hits(37, 0);
+    pool.ParallelFor(hits.size(), [&hits](size_t i) { hits[i] += 1; });
+    for (auto hit : hits) EXPECT_EQ(hit, 1);
+  }
+}
+
+TEST_F(TestThreadPool, SingleThread) {
+  ThreadPool pool(1);
+  std::atomic<int> sum(0);
+  pool.ParallelFor(10, [&sum](size_t i) { sum += i; });
+  EXPECT_EQ(sum, 45);
+  pool.ParallelFor(0, [&sum](size_t i) { sum += 1; });
+  EXPECT_EQ(sum, 45);
+}
+
+}  // namespace
+}  // namespace csci5570
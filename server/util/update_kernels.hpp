@@ -0,0 +1,72 @@
+#pragma once
+
+#include "base/magic.hpp"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace csci5570 {
+
+/**
+ * Kernels that apply the values of an Add onto the storage
+ *
+ * The run versions work on contiguous values, e.g. a run of consecutive keys in VectorStorage,
+ * and use SIMD instructions for float and double when available.
+ */
+
+// dst[i] += src[i], for i in [0, n)
+template <typename Val>
+inline void AccumulateRun(Val* dst, const Val* src, size_t n) {
+  for (size_t i = 0; i < n; ++i) dst[i] += src[i];
+}
+
+#if defined(__SSE2__)
+template <>
+inline void AccumulateRun<double>(double* dst, const double* src, size_t n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128d a0 = _mm_add_pd(_mm_loadu_pd(dst + i), _mm_loadu_pd(src + i));
+    __m128d a1 = _mm_add_pd(_mm_loadu_pd(dst + i + 2), _mm_loadu_pd(src + i + 2));
+    _mm_storeu_pd(dst + i, a0);
+    _mm_storeu_pd(dst + i + 2, a1);
+  }
+  for (; i < n; ++i) dst[i] += src[i];
+}
+
+template <>
+inline void AccumulateRun<float>(float* dst, const float* src, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128 a0 = _mm_add_ps(_mm_loadu_ps(dst + i), _mm_loadu_ps(src + i));
+    __m128 a1 = _mm_add_ps(_mm_loadu_ps(dst + i + 4), _mm_loadu_ps(src + i + 4));
+    _mm_storeu_ps(dst + i, a0);
+    _mm_storeu_ps(dst + i + 4, a1);
+  }
+  for (; i < n; ++i) dst[i] += src[i];
+}
+#endif
+
+// apply n contiguous values according to the update mode
+template <typename Val>
+inline void ApplyRun(UpdateMode mode, Val* dst, const Val* src, size_t n) {
+  if (mode == UpdateMode::Accumulate) {
+    AccumulateRun(dst, src, n);
+  } else {
+    memmove(dst, src, n * sizeof(Val));
+  }
+}
+
+// apply a single value according to the update mode
+template <typename Val>
+inline void ApplyOne(UpdateMode mode, Val* dst, const Val& src) {
+  if (mode == UpdateMode::Accumulate) {
+    *dst += src;
+  } else {
+    *dst = src;
+  }
+}
+
+}  // namespace csci5570
@@ -0,0 +1,58 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/util/update_kernels.hpp"
+
+#include <vector>
+
+namespace csci5570 {
+namespace {
+
+class TestUpdateKernels : public testing::Test {
+ public:
+  TestUpdateKernels() {}
+  ~TestUpdateKernels() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+template <typename Val>
+void CheckAccumulateRun(size_t n) {
+  std::vector<Val> dst(n), src(n);
+  for (size_t i = 0; i < n; ++i) {
+    dst[i] = i;
+    src[i] = 2 * i + 1;
+  }
+  ApplyRun(UpdateMode::Accumulate, dst.data(), src.data(), n);
+  for (size_t i = 0; i < n; ++i) {
+    EXPECT_EQ(dst[i], Val(3 * i + 1));
+  }
+}
+
+TEST_F(TestUpdateKernels, AccumulateRun) {
+  for (size_t n : {0, 1, 3, 8, 17}) {  // cover the vector body and the scalar tail
+    CheckAccumulateRun<double>(n);
+    CheckAccumulateRun<float>(n);
+    CheckAccumulateRun<int>(n);
+  }
+}
+
+TEST_F(TestUpdateKernels, AssignRun) {
+  std::vector<double> dst{1, 2, 3};
+  std::vector<double> src{4, 5, 6};
+  ApplyRun(UpdateMode::Assign, dst.data(), src.data(), 3);
+  EXPECT_EQ(dst, src);
+}
+
+TEST_F(TestUpdateKernels, ApplyOne) {
+  int v = 3;
+  ApplyOne(UpdateMode::Accumulate, &v, 2);
+  EXPECT_EQ(v, 5);
+  ApplyOne(UpdateMode::Assign, &v, 2);
+  EXPECT_EQ(v, 2);
+}
+
+}  // namespace
+}  // namespace csci5570
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "base/message.hpp"
+#include "base/third_party/range.h"
+#include "server/abstract_storage.hpp"
+#include "server/add_log_storage.hpp"
+#include "server/hash_storage.hpp"
+#include "server/optimizer/abstract_optimizer.hpp"
+#include "server/util/initializer.hpp"
+#include "server/util/update_kernels.hpp"
+
+#include "glog/logging.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace csci5570 {
+
+/**
+ * Dense storage for the key range owned by one server thread
+ * The row of key k is kept at storage_[(k - range.begin()) * row_width]
+ * Runs of consecutive keys in a request are applied and copied as contiguous blocks
+ */
+template <typename Val>
+class VectorStorage : public AbstractStorage {
+ public:
+  /**
+   * @param range   the key range [begin, end) owned by this server thread
+   * @param mode        whether an Add overwrites or accumulates into the stored value
+   * @param row_width   the number of values per key
+   */
+  explicit VectorStorage(const third_party::Range& range, UpdateMode mode = UpdateMode::Assign, size_t row_width = 1)
+      : range_(range), mode_(mode), row_width_(row_width), storage_(range.size() * row_width) {
+    CHECK_GT(row_width_, 0);
+  }
+
+  virtual void SubAdd(const third_party::SArray<Key>& typed_keys,
+      const third_party::SArray<char>& vals) override {
+    auto typed_vals = third_party::SArray<Val>(vals);
+    CHECK_EQ(typed_keys.size() * row_width_, typed_vals.size());
+
+    if (optimizer_) {
+      std::vector<size_t> slots(typed_vals.size());
+      for (size_t i = 0; i < slots.size(); ++i) slots[i] = Offset(typed_keys[i / row_width_]) + i % row_width_;
+      std::vector<Val*> states(states_.size());
+      for (int i = 0; i < states_.size(); ++i) states[i] = states_[i].data();
+      optimizer_->Update(slots.data(), typed_vals.data(), slots.size(), storage_.data(), states.data());
+      return;
+    }
+    Apply(mode_, typed_keys, typed_vals);
+  }
+
+  virtual void SubAssign(const third_party::SArray<Key>& typed_keys,
+      const third_party::SArray<char>& vals) override {
+    auto typed_vals = third_party::SArray<Val>(vals);
+    CHECK_EQ(typed_keys.size() * row_width_, typed_vals.size());
+    Apply(UpdateMode::Assign, typed_keys, typed_vals);
+  }
+
+  virtual third_party::SArray<char> SubGet(const third_party::SArray<Key>& typed_keys) override {
+    third_party::SArray<Val> reply_vals(typed_keys.size() * row_width_);
+    size_t run_end;
+    for (size_t i = 0; i < typed_keys.size(); i = run_end) {
+      run_end = RunEnd(typed_keys, i);
+      memcpy(reply_vals.data() + i * row_width_, &storage_[Offset(typed_keys[i])],
+             (run_end - i) * row_width_ * sizeof(Val));
+    }
+    return third_party::SArray<char>(reply_vals);
+  }
+
+  virtual std::unique_ptr<AbstractStorage> CreateDelta() const override {
+    if (optimizer_) return std::unique_ptr<AbstractStorage>(new AddLogStorage());
+    return std::unique_ptr<AbstractStorage>(new HashStorage<Val>(0, mode_, row_width_));
+  }
+
+  virtual void FinishIter() override {}
+
+  /**
+   * Treat the values of Add as gradients of an optimizer, whose states are kept next to the values
+   */
+  void SetOptimizer(std::unique_ptr<AbstractOptimizer<Val>>&& optimizer) {
+    optimizer_ = std::move(optimizer);
+    states_.assign(optimizer_ ? optimizer_->GetNumStates() : 0, std::vector<Val>(storage_.size()));
+  }
+
+  /**
+   * Set the initial values of all keys in the range
+   */
+  void SetInitializer(const Initializer& initializer) {
+    if (initializer.IsZero()) return;
+    for (Key key = range_.begin(); key < range_.end(); ++key) initializer.Fill(key, &storage_[Offset(key)], row_width_);
+  }
+
+  const third_party::Range& GetRange() const { return range_; }
+
+ private:
+  void Apply(UpdateMode mode, const third_party::SArray<Key>& typed_keys, const third_party::SArray<Val>& typed_vals) {
+    size_t run_end;
+    for (size_t i = 0; i < typed_keys.size(); i = run_end) {
+      run_end = RunEnd(typed_keys, i);
+      ApplyRun(mode, &storage_[Offset(typed_keys[i])], typed_vals.data() + i * row_width_, (run_end - i) * row_width_);
+    }
+  }
+
+  // the end of the run of consecutive keys starting at position begin
+  size_t RunEnd(const third_party::SArray<Key>& keys, size_t begin) const {
+    size_t end = begin + 1;
+    while (end < keys.size() && keys[end] == keys[end - 1] + 1) ++end;
+    DCHECK_LT(keys[end - 1], range_.end());
+    return end;
+  }
+
+  // the position of the row of key in storage_
+  size_t Offset(Key key) const {
+    DCHECK(range_.begin() <= key && key < range_.end()) << "key " << key << " is out of the range of this server";
+    return (key - range_.begin()) * row_width_;
+  }
+
+  third_party::Range range_;  // the key range [begin, end) of this shard
+  UpdateMode mode_;
+  size_t row_width_;
+  std::unique_ptr<AbstractOptimizer<Val>> optimizer_;  // Adds are gradients when set
+  std::vector<Val> storage_;
+  std::vector<std::vector<Val>> states_;  // optimizer states, parallel to storage_
+};
+
+}  // namespace csci5570
@@ -0,0 +1,133 @@
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include "server/optimizer/optimizers.hpp"
+#include "server/vector_storage.hpp"
+
+#include <cmath>
+#include <vector>
+
+namespace csci5570 {
+namespace {
+
+class TestVectorStorage : public testing::Test {
+ public:
+  TestVectorStorage() {}
+  ~TestVectorStorage() {}
+
+ protected:
+  void SetUp() {}
+  void TearDown() {}
+};
+
+TEST_F(TestVectorStorage, AddGetInt) {
+  VectorStorage<int> s(third_party::Range(10, 20));
+
+  Message m;
+  third_party::SArray<Key> s_keys({13, 14, 15});
+  third_party::SArray<int> s_vals({1, 2, 3});
+  m.AddData(s_keys);
+  m.AddData(s_vals);
+  s.Add(m);
+
+  Message m2;
+  m2.AddData(s_keys);
+  Message rep = s.Get(m2);
+
+  EXPECT_EQ(rep.data.size(), 2);
+  auto rep_keys = third_party::SArray<Key>(rep.data[0]);
+  auto rep_vals = third_party::SArray<int>(rep.data[1]);
+  for (int index = 0; index < s_keys.size(); index++) {
+    EXPECT_EQ(rep_keys[index], s_keys[index]);
+    EXPECT_EQ(rep_vals[index], s_vals[index]);
+  }
+}
+
+TEST_F(TestVectorStorage, SubAddSubGetDouble) {
+  VectorStorage<double> s(third_party::Range(100, 104));
+
+  third_party::SArray<Key> s_keys({100, 103});
+  third_party::SArray<double> s_vals({0.1, 0.4});
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+
+  third_party::SArray<Key> all_keys({100, 101, 102, 103});
+  third_party::SArray<double> ret = third_party::SArray<double>(s.SubGet(all_keys));
+  ASSERT_EQ(ret.size(), 4);
+  EXPECT_DOUBLE_EQ(ret[0], 0.1);
+  EXPECT_DOUBLE_EQ(ret[1], 0.0);  // untouched keys are zero-initialized
+  EXPECT_DOUBLE_EQ(ret[2], 0.0);
+  EXPECT_DOUBLE_EQ(ret[3], 0.4);
+}
+
+TEST_F(TestVectorStorage, Accumulate) {
+  VectorStorage<double> s(third_party::Range(0, 100), UpdateMode::Accumulate);
+
+  // a run of consecutive keys followed by scattered keys
+  third_party::SArray<Key> s_keys({10, 11, 12, 13, 14, 50, 70, 71});
+  third_party::SArray<double> s_vals({1, 2, 3, 4, 5, 6, 7, 8});
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+
+  third_party::SArray<double> ret = third_party::SArray<double>(s.SubGet(s_keys));
+  ASSERT_EQ(ret.size(), s_keys.size());
+  for (int i = 0; i < s_keys.size(); ++i) {
+    EXPECT_DOUBLE_EQ(ret[i], 2 * s_vals[i]);
+  }
+}
+
+TEST_F(TestVectorStorage, Optimizer) {
+  VectorStorage<double> s(third_party::Range(0, 10));
+  OptimizerConfig config;
+  config.type = OptimizerType::Adagrad;
+  config.learning_rate = 1.0;
+  config.epsilon = 0;
+  s.SetOptimizer(CreateOptimizer<double>(config));
+
+  third_party::SArray<Key> s_keys({2, 7});
+  third_party::SArray<double> s_grads({3.0, -4.0});
+  s.SubAdd(s_keys, third_party::SArray<char>(s_grads));
+  s.SubAdd(s_keys, third_party::SArray<char>(s_grads));
+
+  third_party::SArray<double> ret = third_party::SArray<double>(s.SubGet(s_keys));
+  EXPECT_DOUBLE_EQ(ret[0], -1.0 - 3.0 / std::sqrt(18.0));
+  EXPECT_DOUBLE_EQ(ret[1], 1.0 + 4.0 / std::sqrt(32.0));
+}
+
+TEST_F(TestVectorStorage, OptimizerAddBatch) {
+  VectorStorage<double> s(third_party::Range(0, 10));
+  OptimizerConfig config;
+  config.type = OptimizerType::Adagrad;
+  config.learning_rate = 1.0;
+  config.epsilon = 0;
+  s.SetOptimizer(CreateOptimizer<double>(config));
+
+  // each Add of the batch is one step, as in the Optimizer test, not one step on the summed gradients
+  std::vector<Message> msgs(2);
+  for (auto& msg : msgs) {
+    msg.AddData(third_party::SArray<Key>({2, 7}));
+    msg.AddData(third_party::SArray<double>({3.0, -4.0}));
+  }
+  s.AddBatch(msgs);
+
+  third_party::SArray<double> ret = third_party::SArray<double>(s.SubGet(third_party::SArray<Key>({2, 7})));
+  EXPECT_DOUBLE_EQ(ret[0], -1.0 - 3.0 / std::sqrt(18.0));
+  EXPECT_DOUBLE_EQ(ret[1], 1.0 + 4.0 / std::sqrt(32.0));
+}
+
+TEST_F(TestVectorStorage, Rows) {
+  VectorStorage<float> s(third_party::Range(0, 8), UpdateMode::Accumulate, 3);
+
+  third_party::SArray<Key> s_keys({2, 3, 6});
+  third_party::SArray<float> s_vals({1, 2, 3, 4, 5, 6, 7, 8, 9});
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+  s.SubAdd(s_keys, third_party::SArray<char>(s_vals));
+
+  third_party::SArray<Key> get_keys({1, 2, 3, 6});
+  third_party::SArray<float> ret = third_party::SArray<float>(s.SubGet(get_keys));
+  ASSERT_EQ(ret.size(), 12);
+  for (int i = 0; i < 3; ++i) EXPECT_FLOAT_EQ(ret[i], 0);
+  for (int i = 0; i < 9; ++i) EXPECT_FLOAT_EQ(ret[i + 3], 2 * s_vals[i]);
+}
+
+}  // namespace
+}  // namespace csci5570
@@ -1,90 +1,94 @@
 #pragma once
 
 #include <functional>
+#include <unordered_map>
 
 #include "base/message.hpp"
 
+#include "glog/logging.h"
+
 namespace csci5570 {
 
 class AbstractCallbackRunner {
  public:
   /**
-   * Register callbacks for receiving a message
-   */
-  virtual void RegisterRecvHandle(uint32_t app_thread_id, uint32_t model_id,
-                                  const std::function<void(Message&)>& recv_handle) = 0;
-  /**
-   * Register callbacks for when all expected responses are received
+   * Used by the worker threads on receival of messages and to invoke the callbacks of their request
    */
-  virtual void RegisterRecvFinishHandle(uint32_t app_thread_id, uint32_t model_id,
-                                        const std::function<void()>& recv_finish_handle) = 0;
+  virtual void AddResponse(uint32_t app_thread_id, uint32_t model_id, Message& msg) = 0;
 
   /**
-   * Register a new request which expects to receive <expected_responses> responses
+   * Register a request with its own callbacks, which may be in flight together with other requests of the
+   * same user thread and model. The responses carry the returned request id in their Meta.
    */
-  virtual void NewRequest(uint32_t app_thread_id, uint32_t model_id, uint32_t expected_responses) = 0;
+  virtual int NewAsyncRequest(uint32_t expected_responses, const std::function<void(Message&)>& recv_handle,
+                              const std::function<void()>& recv_finish_handle) = 0;
 
   /**
-   * Return when the request is completed
+   * Register the callback for the values the servers push to a subscribed user thread
    */
-  virtual void WaitRequest(uint32_t app_thread_id, uint32_t model_id) = 0;
+  virtual void RegisterPushHandle(uint32_t app_thread_id, uint32_t model_id,
+                                  const std::function<void(Message&)>& push_handle) = 0;
 
   /**
-   * Used by the worker threads on receival of messages and to invoke callbacks
+   * Used by the worker threads on receival of pushed values
    */
-  virtual void AddResponse(uint32_t app_thread_id, uint32_t model_id, Message& msg) = 0;
+  virtual void AddPush(uint32_t app_thread_id, uint32_t model_id, Message& msg) = 0;
 };  // class AbstractCallbackRunner
 
 class CallbackRunner: public AbstractCallbackRunner {
   public:
     CallbackRunner() {}
-    void RegisterRecvHandle(uint32_t app_thread_id, uint32_t model_id,
-                            const std::function<void(Message&)>& recv_handle) {
-      recv_handles_[app_thread_id][model_id] = recv_handle;
-    }
-    void RegisterRecvFinishHandle(uint32_t app_thread_id, uint32_t model_id,
-                                        const std::function<void()>& recv_finish_handle) {
-      recv_finish_handles_[app_thread_id][model_id] = recv_finish_handle;
-    }
-    void NewRequest(uint32_t app_thread_id, uint32_t model_id, uint32_t expected_responses) {
-      trackers_[app_thread_id][model_id] = {expected_responses, 0};
-    }
-    void WaitRequest(uint32_t app_thread_id, uint32_t model_id) {
-      std::unique_lock<std::mutex> lk(mu_);
-      cond_.wait(lk, [this, app_thread_id, model_id] {
-          auto tracker = trackers_[app_thread_id][model_id];
-          return tracker.first == tracker.second;
-        });
-    }
     void AddResponse(uint32_t app_thread_id, uint32_t model_id, Message& msg) {
-      bool recv_finish = false;
-      // no such request
-      if (trackers_.find(app_thread_id) == trackers_.end()) return;
-      auto &tracker = trackers_[app_thread_id][model_id];
-      // check if it is the last msg
+      std::function<void(Message&)> recv_handle;
+      std::function<void()> recv_finish_handle;
       {
         std::lock_guard<std::mutex> lk(mu_);
-        recv_finish = tracker.first == tracker.second + 1 ? true : false;
-      }
-      recv_handles_[app_thread_id][model_id](msg);
-      if (recv_finish) {
-        recv_finish_handles_[app_thread_id][model_id]();
+        auto it = async_requests_.find(msg.meta.request_id);
+        CHECK(it != async_requests_.end()) << "no request " << msg.meta.request_id << " of thread " << app_thread_id
+                                           << " on model " << model_id;
+        recv_handle = it->second.recv_handle;
+        if (++it->second.num_responses == it->second.expected_responses) {
+          recv_finish_handle = it->second.recv_finish_handle;
+          async_requests_.erase(it);
+        }
       }
+      recv_handle(msg);
+      if (recv_finish_handle) recv_finish_handle();
+    }
+    int NewAsyncRequest(uint32_t expected_responses, const std::function<void(Message&)>& recv_handle,
+                        const std::function<void()>& recv_finish_handle) {
+      std::lock_guard<std::mutex> lk(mu_);
+      int request_id = next_request_id_++;
+      async_requests_[request_id] = {expected_responses, 0, recv_handle, recv_finish_handle};
+      return request_id;
+    }
+    void RegisterPushHandle(uint32_t app_thread_id, uint32_t model_id,
+                            const std::function<void(Message&)>& push_handle) {
+      std::lock_guard<std::mutex> lk(mu_);
+      push_handles_[app_thread_id][model_id] = push_handle;
+    }
+    void AddPush(uint32_t app_thread_id, uint32_t model_id, Message& msg) {
+      std::function<void(Message&)> push_handle;
       {
         std::lock_guard<std::mutex> lk(mu_);
-        tracker.second += 1;
-        if (recv_finish) {
-          cond_.notify_all();
-        }
+        push_handle = push_handles_[app_thread_id][model_id];
       }
+      // pushes of a table the user thread no longer holds
+      if (push_handle) push_handle(msg);
     }
   private:
+    struct AsyncRequest {
+      uint32_t expected_responses;
+      uint32_t num_responses;
+      std::function<void(Message&)> recv_handle;
+      std::function<void()> recv_finish_handle;
+    };
+
     std::mutex mu_;// lockable obj
-    std::condition_variable cond_;
     // app_thread_id(user thread)   model_id
-    std::map<uint32_t, std::map<uint32_t, std::function<void(Message&)>>> recv_handles_;
-    std::map<uint32_t, std::map<uint32_t, std::function<void()>>> recv_finish_handles_;
-    std::map<uint32_t, std::map<uint32_t, std::pair<uint32_t, uint32_t>>> trackers_;
+    std::map<uint32_t, std::map<uint32_t, std::function<void(Message&)>>> push_handles_;
+    std::unordered_map<int, AsyncRequest> async_requests_;  // request id -> its state
+    int next_request_id_ = 0;
 };
 
 }  // namespace csci5570
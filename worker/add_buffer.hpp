@@ -0,0 +1,94 @@
+#pragma once
+
+#include "base/magic.hpp"
+#include "base/third_party/sarray.h"
+
+#include "glog/logging.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace csci5570 {
+
+/**
+ * The settings of the Add buffer of a table
+ */
+struct AddBufferConfig {
+  UpdateMode mode = UpdateMode::Assign;  // how two Adds to a key combine, as on the servers
+  size_t max_bytes = 0;                  // the size at which the buffer is flushed
+};
+
+/**
+ * Collects the Adds of a worker thread to a table, one row per key
+ *
+ * Adds to a key already in the buffer are summed into its row, or overwrite it, following the update mode of the
+ * table, which is how the servers would apply them one after the other.
+ */
+template <typename Val>
+class AddBuffer {
+ public:
+  explicit AddBuffer(const AddBufferConfig& config) : config_(config) {}
+
+  /**
+   * Buffer rows of equal width for keys
+   *
+   * @return  whether the buffer reached its size threshold
+   */
+  bool Add(const third_party::SArray<Key>& keys, const third_party::SArray<Val>& rows) {
+    if (keys.empty()) return Full();
+    size_t row_width = rows.size() / keys.size();
+    if (row_width_ == 0) row_width_ = row_width;
+    CHECK_EQ(row_width, row_width_) << "rows must have the width of the table";
+    for (size_t i = 0; i < keys.size(); ++i) {
+      const Val* src = rows.data() + i * row_width_;
+      auto it = index_.find(keys[i]);
+      if (it == index_.end()) {
+        index_.emplace(keys[i], keys_.size());
+        keys_.push_back(keys[i]);
+        rows_.insert(rows_.end(), src, src + row_width_);
+        continue;
+      }
+      Val* dst = rows_.data() + it->second * row_width_;
+      if (config_.mode == UpdateMode::Accumulate) {
+        for (size_t j = 0; j < row_width_; ++j) dst[j] += src[j];
+      } else {
+        memcpy(dst, src, row_width_ * sizeof(Val));
+      }
+    }
+    return Full();
+  }
+
+  bool Empty() const { return keys_.empty(); }
+  size_t Bytes() const { return keys_.size() * sizeof(Key) + rows_.size() * sizeof(Val); }
+
+  /**
+   * Move the buffered rows out, sorted by key, and empty the buffer
+   */
+  void Take(third_party::SArray<Key>* keys, third_party::SArray<Val>* rows) {
+    std::vector<size_t> order(keys_.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [this](size_t a, size_t b) { return keys_[a] < keys_[b]; });
+    keys->resize(keys_.size());
+    rows->resize(rows_.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+      (*keys)[i] = keys_[order[i]];
+      memcpy(rows->data() + i * row_width_, rows_.data() + order[i] * row_width_, row_width_ * sizeof(Val));
+    }
+    index_.clear();
+    keys_.clear();
+    rows_.clear();
+  }
+
+ private:
+  bool Full() const { return Bytes() >= config_.max_bytes; }
+
+  AddBufferConfig config_;
+  size_t row_width_ = 0;
+  std::unordered_map<Key, size_t> index_;  // key -> its row in rows_
+  std::vector<Key> keys_;                  // in the order of their first Add
+  std::vector<Val> rows_;
+};
+
+}  // namespace csci5570
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "base/magic.hpp"
+#include "base/third_party/sarray.h"
+
+#include "glog/logging.h"
+
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace csci5570 {
+
+/**
+ * The values of a table fetched by the worker threads of a process, shared by all of them
+ *
+ * Rows are kept as they arrive, in the encoding of the table, together with the last clock of a worker at which
+ * they may be read, as stamped on the Get replies by the servers. A Get of a worker at a later clock has to fetch
+ * the key again. Replies without such a clock are not cached.
+ *
+ * A worker that adds to keys erases them, so that its next Get fetches them with its own Add applied. Replies to
+ * Gets sent before the erase may still be in flight, and are not cached for those keys.
+ */
+class ClientCache {
+ public:
+  /**
+   * Copy the rows of the keys readable at <clock> into rows, in the order of keys
+   *
+   * @param rows      resized to keys.size() rows, left empty if no row has been cached yet
+   * @param misses    the positions in keys of the keys to fetch
+   */
+  void Get(const third_party::SArray<Key>& keys, int clock, third_party::SArray<char>* rows,
+           std::vector<size_t>* misses) {
+    std::lock_guard<std::mutex> lk(mu_);
+    misses->clear();
+    if (row_bytes_ == 0) {
+      for (size_t i = 0; i < keys.size(); ++i) misses->push_back(i);
+      num_misses_ += keys.size();
+      return;
+    }
+    rows->resize(keys.size() * row_bytes_);
+    for (size_t i = 0; i < keys.size(); ++i) {
+      auto it = index_.find(keys[i]);
+      if (it == index_.end() || it->second.readable_through < clock) {
+        misses->push_back(i);
+        continue;
+      }
+      memcpy(rows->data() + i * row_bytes_, data_.data() + it->second.offset, row_bytes_);
+    }
+    num_hits_ += keys.size() - misses->size();
+    num_misses_ += misses->size();
+  }
+
+  /**
+   * Cache the rows of a Get reply
+   *
+   * @param readable_through   the last clock at which the rows may be read, negative not to cache them
+   * @param epoch              the epoch when the Get was sent, rows of keys erased since then are not cached
+   */
+  void Insert(const third_party::SArray<Key>& keys, const third_party::SArray<char>& rows, int readable_through,
+              uint64_t epoch) {
+    if (keys.empty() || readable_through < 0) return;
+    std::lock_guard<std::mutex> lk(mu_);
+    if (row_bytes_ == 0) row_bytes_ = rows.size() / keys.size();
+    CHECK_EQ(keys.size() * row_bytes_, rows.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      auto erased = erased_at_.find(keys[i]);
+      if (erased != erased_at_.end() && erased->second > epoch) continue;
+      auto it = index_.find(keys[i]);
+      if (it == index_.end()) {
+        it = index_.emplace(keys[i], Entry{data_.size(), -1}).first;
+        data_.resize(data_.size() + row_bytes_);
+      }
+      // replies of different threads may arrive out of order, keep the freshest
+      if (it->second.readable_through > readable_through) continue;
+      it->second.readable_through = readable_through;
+      memcpy(data_.data() + it->second.offset, rows.data() + i * row_bytes_, row_bytes_);
+    }
+  }
+
+  // drop the rows of keys, and the rows of keys in replies to Gets sent before
+  void Erase(const third_party::SArray<Key>& keys) {
+    std::lock_guard<std::mutex> lk(mu_);
+    ++epoch_;
+    for (auto key : keys) {
+      erased_at_[key] = epoch_;
+      auto it = index_.find(key);
+      if (it != index_.end()) it->second.readable_through = -1;
+    }
+  }
+
+  // to be passed to Insert with the reply of a Get sent now
+  uint64_t GetEpoch() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return epoch_;
+  }
+
+  size_t GetNumHits() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return num_hits_;
+  }
+  size_t GetNumMisses() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return num_misses_;
+  }
+
+ private:
+  struct Entry {
+    size_t offset;  // of the row in data_
+    int readable_through;
+  };
+
+  mutable std::mutex mu_;
+  size_t row_bytes_ = 0;  // known from the first reply
+  std::unordered_map<Key, Entry> index_;
+  std::vector<char> data_;
+  uint64_t epoch_ = 0;                           // the number of Erase calls
+  std::unordered_map<Key, uint64_t> erased_at_;  // key -> the epoch of its last erase
+  size_t num_hits_ = 0;
+  size_t num_misses_ = 0;
+};
+
+}  // namespace csci5570
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "base/abstract_partition_manager.hpp"
+#include "base/message.hpp"
+#include "base/threadsafe_queue.hpp"
+#include "server/util/progress_tracker.hpp"
+
+#include "glog/logging.h"
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace csci5570 {
+
+/**
+ * Collects the clocks of the worker threads of a node, and clocks each table once per node
+ *
+ * The servers track the workers of the node as one group (see ProgressTracker::InitGroup). When the slowest
+ * local worker of a table clocks, the group clock is sent to every server of the table, so a node sends one
+ * clock message per server and iteration instead of one per worker thread. The min clock the servers see is
+ * unchanged, as it is the min over the groups. Since the servers no longer know the clock of each worker,
+ * the tables stamp their Adds and Gets with it.
+ */
+class ClockAggregator {
+ public:
+  /**
+   * @param group_id        the id the clocks of this node are sent with
+   * @param sender_queue    the work queue of the sender communication thread
+   */
+  ClockAggregator(uint32_t group_id, ThreadsafeQueue<Message>* const sender_queue)
+      : group_id_(group_id), sender_queue_(sender_queue) {}
+
+  /**
+   * Start aggregating the clocks of a table over the local worker threads, before they run
+   */
+  void InitTable(uint32_t model_id, const AbstractPartitionManager* const partition_manager,
+                 const std::vector<uint32_t>& tids) {
+    std::lock_guard<std::mutex> lk(mu_);
+    auto& table = tables_[model_id];
+    table.partition_manager = partition_manager;
+    table.tracker = ProgressTracker();
+    table.tracker.Init(tids);
+  }
+
+  bool HasTable(uint32_t model_id) const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return tables_.find(model_id) != tables_.end();
+  }
+
+  /**
+   * Record a clock of a local worker thread, and clock the servers if it was the slowest one
+   */
+  void Clock(uint32_t model_id, uint32_t tid) {
+    std::lock_guard<std::mutex> lk(mu_);
+    auto it = tables_.find(model_id);
+    CHECK(it != tables_.end()) << "table " << model_id << " does not aggregate clocks";
+    auto& table = it->second;
+    if (table.tracker.AdvanceAndGetChangedMinClock(tid) == -1) return;
+    // pushed under the lock, so that the servers get the group clocks in order
+    Message msg;
+    msg.meta.flag = Flag::kClock;
+    msg.meta.model_id = model_id;
+    msg.meta.sender = group_id_;
+    for (auto sid : table.partition_manager->GetServerThreadIds()) {
+      msg.meta.recver = sid;
+      sender_queue_->Push(msg);
+    }
+  }
+
+  uint32_t GetGroupId() const { return group_id_; }
+
+ private:
+  struct Table {
+    const AbstractPartitionManager* partition_manager = nullptr;
+    ProgressTracker tracker;  // the clocks of the local worker threads
+  };
+
+  uint32_t group_id_;
+  ThreadsafeQueue<Message>* const sender_queue_;
+  mutable std::mutex mu_;
+  std::map<uint32_t, Table> tables_;
+};
+
+}  // namespace csci5570
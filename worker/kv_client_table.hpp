@@ -5,9 +5,22 @@
 #include "base/message.hpp"
 #include "base/third_party/sarray.h"
 #include "base/threadsafe_queue.hpp"
+#include "base/value_encoding.hpp"
 #include "worker/abstract_callback_runner.hpp"
+#include "worker/add_buffer.hpp"
+#include "worker/client_cache.hpp"
+#include "worker/clock_aggregator.hpp"
+#include "worker/push_cache.hpp"
 
+#include "glog/logging.h"
+
+#include <algorithm>
 #include <cinttypes>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 namespace csci5570 {
@@ -27,17 +40,31 @@ class KVClientTable {
    * @param sender_queue        the work queue of a sender communication thread
    * @param partition_manager   model partition manager
    * @param callback_runner     callback runner to handle received replies from servers
+   * @param encoding            how the table sends values, converted from and to Val by the table
+   * @param clock_aggregator    the aggregator of the clocks of the node, nullptr to clock the servers directly
+   * @param client_cache        the values of the table cached by the process, nullptr to always ask the servers
    */
   KVClientTable(uint32_t app_thread_id, uint32_t model_id, ThreadsafeQueue<Message>* const sender_queue,
-                const AbstractPartitionManager* const partition_manager, AbstractCallbackRunner* const callback_runner)
+                const AbstractPartitionManager* const partition_manager, AbstractCallbackRunner* const callback_runner,
+                ValueEncoding encoding = ValueEncoding::Native, ClockAggregator* const clock_aggregator = nullptr,
+                ClientCache* const client_cache = nullptr)
       : app_thread_id_(app_thread_id),
         model_id_(model_id),
         sender_queue_(sender_queue),
         partition_manager_(partition_manager),
-        callback_runner_(callback_runner) {};
+        callback_runner_(callback_runner),
+        encoding_(encoding),
+        clock_aggregator_(clock_aggregator),
+        client_cache_(client_cache) {};
 
   // ========== API ========== //
   void Clock() {
+    FlushAdds();  // the Adds of the clock reach the servers before the clock does
+    ++clock_;
+    if (clock_aggregator_ != nullptr) {
+      clock_aggregator_->Clock(model_id_, app_thread_id_);
+      return;
+    }
     // send clock msg to every server
     auto server_ids = partition_manager_->GetServerThreadIds();
     Message msg;
@@ -54,68 +81,402 @@ class KVClientTable {
     Add(third_party::SArray<Key>(keys), third_party::SArray<Val>(vals));
   }
   void Get(const std::vector<Key>& keys, std::vector<Val>* vals) {
+    size_t offset = vals->size();
+    vals->resize(offset + keys.size());
+    GetInto(third_party::SArray<Key>(keys), vals->data() + offset, keys.size());
+  }
+  // sarray version
+  void Add(const third_party::SArray<Key>& keys, const third_party::SArray<Val>& vals) {
+    CHECK_EQ(keys.size(), vals.size());
+    AddRows(keys, vals);  // rows of one value
+  }
+  // the values are appended in the order of keys
+  void Get(const third_party::SArray<Key>& keys, third_party::SArray<Val>* vals) {
+    size_t offset = vals->size();
+    vals->resize(offset + keys.size());
+    GetInto(keys, vals->data() + offset, keys.size());
+  }
+
+  /**
+   * Get the rows of keys into a buffer of the caller, in the order of keys
+   * Each reply is decoded straight into the rows of its keys, without intermediate copies.
+   *
+   * @param rows        the buffer, for keys.size() rows of capacity / keys.size() values
+   * @param capacity    the number of values the buffer holds
+   */
+  void GetInto(const third_party::SArray<Key>& keys, Val* rows, size_t capacity) {
+    if (keys.empty()) return;
+    FlushAdds();
+    CHECK_EQ(capacity % keys.size(), 0) << "the buffer must hold rows of the same width";
+    third_party::SArray<Key> unique_keys;
+    std::vector<size_t> reverse;
+    if (NormalizeKeys(keys, &unique_keys, &reverse)) {
+      size_t row_width = capacity / keys.size();
+      third_party::SArray<Val> unique_rows(unique_keys.size() * row_width);
+      GetInto(unique_keys, unique_rows.data(), unique_rows.size());
+      ExpandRows(unique_rows.data(), reverse, row_width, rows);
+      return;
+    }
+    if (push_cache_ != nullptr || client_cache_ != nullptr) {
+      // the locally held rows are copied once
+      third_party::SArray<Val> local;
+      GetRows(keys, &local);
+      CHECK_EQ(local.size(), capacity);
+      memcpy(rows, local.data(), capacity * sizeof(Val));
+      return;
+    }
+    size_t row_width = capacity / keys.size();
+    size_t row_bytes = row_width * EncodedSize<Val>(encoding_);
+    auto encoding = encoding_;
+    auto get = std::make_shared<PendingGet>();
+    get->scatter = [rows, row_width, row_bytes, encoding](Message& msg, const std::vector<size_t>& positions) {
+      CHECK_EQ(msg.data[1].size(), positions.size() * row_bytes) << "the rows do not fit the buffer";
+      const char* src = msg.data[1].data();
+      // decode runs of consecutive positions at once
+      size_t j = 0;
+      while (j < positions.size()) {
+        size_t k = j + 1;
+        while (k < positions.size() && positions[k] == positions[k - 1] + 1) ++k;
+        DecodeValuesInto<Val>(encoding, src + j * row_bytes, (k - j) * row_width, rows + positions[j] * row_width);
+        j = k;
+      }
+    };
+    WaitForGet(keys, get);
+  }
+
+  // row version, for tables created with TableConfig::row_width > 1
+  // rows hold keys.size() rows of equal width back to back, the row width is rows.size() / keys.size()
+  void AddRows(const std::vector<Key>& keys, const std::vector<Val>& rows) {
+    AddRows(third_party::SArray<Key>(keys), third_party::SArray<Val>(rows));
+  }
+  void GetRows(const std::vector<Key>& keys, std::vector<Val>* rows) {
+    third_party::SArray<Val> ret;
+    GetRows(third_party::SArray<Key>(keys), &ret);
+    rows->assign(ret.begin(), ret.end());
+  }
+  void AddRows(const third_party::SArray<Key>& keys, const third_party::SArray<Val>& rows) {
+    if (keys.empty()) return;
+    CHECK_EQ(rows.size() % keys.size(), 0) << "rows must have the same width";
+    if (add_buffer_ != nullptr) {
+      if (add_buffer_->Add(keys, rows)) FlushAdds();
+      return;
+    }
+    if (normalize_keys_ && !IsSortedUnique(keys)) {
+      // combine the rows of a key once here rather than on the servers
+      AddBufferConfig config;
+      config.mode = combine_mode_;
+      AddBuffer<Val> combined(config);
+      combined.Add(keys, rows);
+      third_party::SArray<Key> unique_keys;
+      third_party::SArray<Val> unique_rows;
+      combined.Take(&unique_keys, &unique_rows);
+      SendRows(unique_keys, unique_rows);
+      return;
+    }
+    SendRows(keys, rows);
+  }
+  // the rows are returned in the order of keys
+  void GetRows(const third_party::SArray<Key>& keys, third_party::SArray<Val>* rows) {
+    FlushAdds();
+    third_party::SArray<Key> unique_keys;
+    std::vector<size_t> reverse;
+    if (NormalizeKeys(keys, &unique_keys, &reverse)) {
+      third_party::SArray<Val> unique_rows;
+      GetRows(unique_keys, &unique_rows);
+      size_t row_width = unique_rows.size() / unique_keys.size();
+      rows->resize(keys.size() * row_width);
+      ExpandRows(unique_rows.data(), reverse, row_width, rows->data());
+      return;
+    }
+    if (ReadPushed(keys, rows)) return;
+    if (client_cache_ != nullptr) {
+      GetCached(keys, rows);
+      return;
+    }
+    third_party::SArray<char> encoded;
+    FetchRows(keys, &encoded);
+    *rows = DecodeValues<Val>(encoding_, encoded);
+  }
+
+  /**
+   * Buffer the Adds of this thread and send them at the next Clock, one message per server
+   * Adds to the same key are merged in the buffer as the servers would apply them, so a key written many times in
+   * a clock is sent once. The buffer is also sent when it reaches max_bytes, and before a Get of this thread so
+   * that it reads its own writes as without the buffer.
+   *
+   * @param mode        Accumulate to sum the rows of a key, Assign to keep the last one
+   * @param max_bytes   the size of the buffered keys and rows at which they are sent before the Clock
+   */
+  void EnableAddBuffer(UpdateMode mode, size_t max_bytes) {
+    AddBufferConfig config;
+    config.mode = mode;
+    config.max_bytes = max_bytes;
+    FlushAdds();
+    add_buffer_.reset(new AddBuffer<Val>(config));
+  }
+
+  /**
+   * Sort and deduplicate the keys of every Get and Add before slicing them
+   * The servers then look up each key once and in order, and the rows of a Get are expanded back to the order of
+   * the keys of the caller. The rows of a key in one Add are combined as the servers would apply them.
+   *
+   * @param mode   Accumulate to sum the rows of a key in an Add, Assign to keep the last one
+   */
+  void EnableKeyNormalization(UpdateMode mode) {
+    normalize_keys_ = true;
+    combine_mode_ = mode;
+  }
+
+  /**
+   * Start a Get of the rows of keys and return at once, e.g. to fetch the next mini-batch during the current one
+   * The future is ready with the rows in the order of keys once every server replied. Requests of a thread may be
+   * in flight together on a table, and are stamped with the clock of the thread when they are sent.
+   * There is no AddAsync as Adds never wait for the servers.
+   */
+  std::future<third_party::SArray<Val>> GetAsync(const third_party::SArray<Key>& keys) {
+    FlushAdds();
+    third_party::SArray<Key> unique_keys;
+    auto reverse = std::make_shared<std::vector<size_t>>();  // empty if the keys are sent as they are
+    if (!NormalizeKeys(keys, &unique_keys, reverse.get())) unique_keys = keys;
+    auto get = std::make_shared<PendingGet>();
+    auto encoded = std::make_shared<third_party::SArray<char>>();
+    get->scatter = ScatterEncoded(encoded.get(), unique_keys.size());
+    auto promise = std::make_shared<std::promise<third_party::SArray<Val>>>();
+    auto encoding = encoding_;
+    size_t num_unique = unique_keys.size();
+    SendGet(unique_keys, get, [encoded, promise, encoding, reverse, num_unique] {
+      auto unique_rows = DecodeValues<Val>(encoding, *encoded);
+      if (reverse->empty()) {
+        promise->set_value(unique_rows);
+        return;
+      }
+      size_t row_width = unique_rows.size() / num_unique;
+      third_party::SArray<Val> rows(reverse->size() * row_width);
+      ExpandRows(unique_rows.data(), *reverse, row_width, rows.data());
+      promise->set_value(rows);
+    });
+    return promise->get_future();
+  }
+
+  // Eager SSP, for SSP tables: the servers push the values of the keys whenever they change at a min clock
+  // advance, and Gets of subscribed keys are served from the pushed values. The Adds of this thread are seen
+  // once they are pushed back, as are those of other threads.
+  void Subscribe(const std::vector<Key>& keys) { Subscribe(third_party::SArray<Key>(keys)); }
+  void Subscribe(const third_party::SArray<Key>& keys) {
     std::vector<std::pair<int, AbstractPartitionManager::Keys>> sliced;
-    partition_manager_->Slice(AbstractPartitionManager::Keys(keys), &sliced);
-    callback_runner_->RegisterRecvHandle(app_thread_id_, model_id_,
-      [vals](Message &msg) {
-        third_party::SArray<Val> temp(msg.data[1]);
-        vals->insert(vals->end(), temp.begin(), temp.end());
-      });
-    callback_runner_->RegisterRecvFinishHandle(app_thread_id_, model_id_, []{});
-
-    callback_runner_->NewRequest(app_thread_id_, model_id_, sliced.size());
-    // send request
+    partition_manager_->Slice(keys, &sliced);
+    // the push handle outlives the table, which may also be moved
+    auto push_cache = std::make_shared<PushCache<Val>>(sliced.size());
+    auto encoding = encoding_;
+    callback_runner_->RegisterPushHandle(app_thread_id_, model_id_,
+      [push_cache, encoding](Message& msg) { push_cache->OnPush(encoding, msg); });
+    push_cache_ = push_cache;
     for (auto piece : sliced) {
       Message msg;
       msg.meta.sender = app_thread_id_;
       msg.meta.recver = piece.first;
       msg.meta.model_id = model_id_;
-      msg.meta.flag = Flag::kGet;
+      msg.meta.flag = Flag::kSubscribe;
       msg.AddData(piece.second);
       sender_queue_->Push(msg);
     }
-    callback_runner_->WaitRequest(app_thread_id_, model_id_);
   }
-  // sarray version
-  void Add(const third_party::SArray<Key>& keys, const third_party::SArray<Val>& vals) {
-    std::vector<std::pair<int,AbstractPartitionManager::KVPairs>> sliced;
-    partition_manager_->Slice(std::make_pair(keys, vals), &sliced);
-    for (auto piece : sliced) {
+  // ========== API ========== //
+
+ private:
+  // the servers know the clock of this thread, unless they only see the clocks of its node
+  int MessageClock() const { return clock_aggregator_ != nullptr ? clock_ : -1; }
+
+  // slice rows of equal width by server and send them as Adds
+  void SendRows(const third_party::SArray<Key>& keys, const third_party::SArray<Val>& rows) {
+    // the next Get of this thread reads its own Add from the servers
+    if (client_cache_ != nullptr) client_cache_->Erase(keys);
+    size_t row_width = rows.size() / keys.size();
+    std::vector<std::pair<int, AbstractPartitionManager::Keys>> sliced;
+    std::vector<std::vector<size_t>> positions;
+    SliceWithPositions(keys, &sliced, &positions);
+    for (size_t i = 0; i < sliced.size(); ++i) {
+      auto& piece_keys = sliced[i].second;
+      third_party::SArray<Val> piece_rows(piece_keys.size() * row_width);
+      for (size_t j = 0; j < piece_keys.size(); ++j) {
+        memcpy(piece_rows.data() + j * row_width, rows.data() + positions[i][j] * row_width, row_width * sizeof(Val));
+      }
       Message msg;
       msg.meta.sender = app_thread_id_;
-      msg.meta.recver = piece.first;
+      msg.meta.recver = sliced[i].first;
       msg.meta.model_id = model_id_;
+      msg.meta.clock = MessageClock();
       msg.meta.flag = Flag::kAdd;
-      msg.AddData(piece.second.first);
-      msg.AddData(piece.second.second);
+      msg.AddData(piece_keys);
+      msg.AddData(EncodeValues(encoding_, piece_rows));
       sender_queue_->Push(msg);
     }
   }
-  void Get(const third_party::SArray<Key>& keys, third_party::SArray<Val>* vals) {
+
+  void FlushAdds() {
+    if (add_buffer_ == nullptr || add_buffer_->Empty()) return;
+    third_party::SArray<Key> keys;
+    third_party::SArray<Val> rows;
+    add_buffer_->Take(&keys, &rows);
+    SendRows(keys, rows);
+  }
+
+  static bool IsSortedUnique(const third_party::SArray<Key>& keys) {
+    for (size_t i = 1; i < keys.size(); ++i) {
+      if (keys[i - 1] >= keys[i]) return false;
+    }
+    return true;
+  }
+
+  /**
+   * Sort and deduplicate keys if the table normalizes them
+   *
+   * @param unique_keys   the sorted distinct keys
+   * @param reverse       for each key, the position of its row in unique_keys
+   * @return              false if the keys are to be sent as they are
+   */
+  bool NormalizeKeys(const third_party::SArray<Key>& keys, third_party::SArray<Key>* unique_keys,
+                     std::vector<size_t>* reverse) const {
+    if (!normalize_keys_ || IsSortedUnique(keys)) return false;
+    unique_keys->CopyFrom(keys);
+    std::sort(unique_keys->begin(), unique_keys->end());
+    unique_keys->resize(std::unique(unique_keys->begin(), unique_keys->end()) - unique_keys->begin());
+    reverse->resize(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      (*reverse)[i] = std::lower_bound(unique_keys->begin(), unique_keys->end(), keys[i]) - unique_keys->begin();
+    }
+    return true;
+  }
+
+  // copy row reverse[i] of src to row i of dst
+  static void ExpandRows(const Val* src, const std::vector<size_t>& reverse, size_t row_width, Val* dst) {
+    for (size_t i = 0; i < reverse.size(); ++i) {
+      memcpy(dst + i * row_width, src + reverse[i] * row_width, row_width * sizeof(Val));
+    }
+  }
+
+  // serve a Get from the pushed values if the keys are subscribed to
+  bool ReadPushed(const third_party::SArray<Key>& keys, third_party::SArray<Val>* rows) {
+    return push_cache_ != nullptr && push_cache_->Get(keys, clock_, rows);
+  }
+
+  // read the keys the cache holds for the current clock, and fetch the others
+  void GetCached(const third_party::SArray<Key>& keys, third_party::SArray<Val>* rows) {
+    third_party::SArray<char> encoded;
+    std::vector<size_t> misses;
+    client_cache_->Get(keys, clock_, &encoded, &misses);
+    if (!misses.empty()) {
+      third_party::SArray<Key> miss_keys(misses.size());
+      for (size_t i = 0; i < misses.size(); ++i) miss_keys[i] = keys[misses[i]];
+      third_party::SArray<char> fetched;
+      FetchRows(miss_keys, &fetched);
+      size_t row_bytes = fetched.size() / miss_keys.size();
+      if (encoded.size() != keys.size() * row_bytes) encoded.resize(keys.size() * row_bytes);
+      for (size_t i = 0; i < misses.size(); ++i) {
+        memcpy(encoded.data() + misses[i] * row_bytes, fetched.data() + i * row_bytes, row_bytes);
+      }
+    }
+    *rows = DecodeValues<Val>(encoding_, encoded);
+  }
+
+  // the state of a Get in flight, shared with its callbacks on the worker helper thread
+  struct PendingGet {
     std::vector<std::pair<int, AbstractPartitionManager::Keys>> sliced;
-    partition_manager_->Slice(keys, &sliced);
-    callback_runner_->RegisterRecvHandle(app_thread_id_, model_id_,
-      [vals](Message &msg) {
-        third_party::SArray<Val> temp(msg.data[1]);
-        vals->append(temp);
-      });
-    callback_runner_->RegisterRecvFinishHandle(app_thread_id_, model_id_, []{});
-    
-    callback_runner_->NewRequest(app_thread_id_, model_id_, sliced.size());
-    for (auto piece : sliced) {
+    std::vector<std::vector<size_t>> positions;
+    // place the rows of a reply at the positions in keys of its keys
+    std::function<void(Message&, const std::vector<size_t>&)> scatter;
+  };
+
+  // collect encoded rows in the order of keys, the row width is learned from the first reply
+  static std::function<void(Message&, const std::vector<size_t>&)> ScatterEncoded(third_party::SArray<char>* encoded,
+                                                                                   size_t num_keys) {
+    return [encoded, num_keys](Message& msg, const std::vector<size_t>& positions) {
+      size_t row_bytes = msg.data[1].size() / positions.size();
+      if (encoded->size() != num_keys * row_bytes) encoded->resize(num_keys * row_bytes);
+      for (size_t j = 0; j < positions.size(); ++j) {
+        memcpy(encoded->data() + positions[j] * row_bytes, msg.data[1].data() + j * row_bytes, row_bytes);
+      }
+    };
+  }
+
+  // fetch the encoded rows of keys from the servers, in the order of keys, and cache them
+  void FetchRows(const third_party::SArray<Key>& keys, third_party::SArray<char>* encoded) {
+    auto get = std::make_shared<PendingGet>();
+    get->scatter = ScatterEncoded(encoded, keys.size());
+    WaitForGet(keys, get);
+  }
+
+  void WaitForGet(const third_party::SArray<Key>& keys, const std::shared_ptr<PendingGet>& get) {
+    auto done = std::make_shared<std::promise<void>>();
+    SendGet(keys, get, [done] { done->set_value(); });
+    done->get_future().wait();
+  }
+
+  // send a Get of keys as a request of its own, on_finish runs on the worker helper thread after the last reply
+  void SendGet(const third_party::SArray<Key>& keys, const std::shared_ptr<PendingGet>& get,
+               const std::function<void()>& on_finish) {
+    SliceWithPositions(keys, &get->sliced, &get->positions);
+    if (get->sliced.empty()) {
+      on_finish();
+      return;
+    }
+    auto* client_cache = client_cache_;
+    uint64_t epoch = client_cache != nullptr ? client_cache->GetEpoch() : 0;
+    int request_id = callback_runner_->NewAsyncRequest(get->sliced.size(),
+      [get, client_cache, epoch](Message& msg) {
+        third_party::SArray<Key> reply_keys(msg.data[0]);
+        if (reply_keys.empty()) return;
+        if (client_cache != nullptr) client_cache->Insert(reply_keys, msg.data[1], msg.meta.clock, epoch);
+        size_t i = 0;
+        while (get->sliced[i].first != msg.meta.sender) ++i;
+        get->scatter(msg, get->positions[i]);
+      }, on_finish);
+    for (auto& piece : get->sliced) {
       Message msg;
       msg.meta.sender = app_thread_id_;
       msg.meta.recver = piece.first;
       msg.meta.model_id = model_id_;
+      msg.meta.clock = MessageClock();
+      msg.meta.request_id = request_id;
       msg.meta.flag = Flag::kGet;
       msg.AddData(piece.second);
       sender_queue_->Push(msg);
     }
-    callback_runner_->WaitRequest(app_thread_id_, model_id_);
   }
-  // ========== API ========== //
 
- private:
+  /**
+   * Slice keys, and find for every sliced key its position in keys
+   * Relies on the partition managers keeping the relative order of keys within a slice
+   */
+  void SliceWithPositions(const third_party::SArray<Key>& keys,
+                          std::vector<std::pair<int, AbstractPartitionManager::Keys>>* sliced,
+                          std::vector<std::vector<size_t>>* positions) const {
+    partition_manager_->Slice(keys, sliced);
+    positions->resize(sliced->size());
+    if (IsSortedUnique(keys)) {
+      // each sliced key is found by binary search, without indexing keys
+      for (size_t i = 0; i < sliced->size(); ++i) {
+        auto& piece_keys = (*sliced)[i].second;
+        (*positions)[i].resize(piece_keys.size());
+        for (size_t j = 0; j < piece_keys.size(); ++j) {
+          (*positions)[i][j] = std::lower_bound(keys.begin(), keys.end(), piece_keys[j]) - keys.begin();
+        }
+      }
+      return;
+    }
+    // the positions of each key from last to first, so that duplicates are taken in order by pop_back
+    std::unordered_map<Key, std::vector<size_t>> index;
+    for (size_t i = keys.size(); i > 0; --i) index[keys[i - 1]].push_back(i - 1);
+    for (size_t i = 0; i < sliced->size(); ++i) {
+      auto& piece_keys = (*sliced)[i].second;
+      (*positions)[i].resize(piece_keys.size());
+      for (size_t j = 0; j < piece_keys.size(); ++j) {
+        auto& key_positions = index[piece_keys[j]];
+        (*positions)[i][j] = key_positions.back();
+        key_positions.pop_back();
+      }
+    }
+  }
 
   uint32_t app_thread_id_;  // identifies the user thread
   uint32_t model_id_;       // identifies the model on servers
@@ -123,6 +484,14 @@ class KVClientTable {
   ThreadsafeQueue<Message>* const sender_queue_;             // not owned
   AbstractCallbackRunner* const callback_runner_;            // not owned
   const AbstractPartitionManager* const partition_manager_;  // not owned
+  ValueEncoding encoding_;                                   // the encoding of values in messages
+  ClockAggregator* const clock_aggregator_;                  // not owned, nullptr if the table is not aggregated
+  ClientCache* const client_cache_;                          // not owned, nullptr if the process caches no values
+  int clock_ = 0;                                            // the number of Clock calls
+  std::shared_ptr<PushCache<Val>> push_cache_;               // the pushed values, nullptr if not subscribed
+  std::unique_ptr<AddBuffer<Val>> add_buffer_;               // the unsent Adds, nullptr if Adds are sent at once
+  bool normalize_keys_ = false;                              // sort and deduplicate keys before slicing them
+  UpdateMode combine_mode_ = UpdateMode::Assign;             // how the rows of a key in one Add are combined
 
 };  // class KVClientTable
 
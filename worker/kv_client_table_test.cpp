@@ -51,30 +51,6 @@ class FakePartitionManager : public AbstractPartitionManager {
 class FakeCallbackRunner : public AbstractCallbackRunner {
  public:
   FakeCallbackRunner() {}
-  void RegisterRecvHandle(uint32_t app_thread_id, uint32_t model_id,
-                          const std::function<void(Message&)>& recv_handle) override {
-    EXPECT_EQ(app_thread_id, kTestAppThreadId);
-    EXPECT_EQ(model_id, kTestModelId);
-    recv_handle_ = recv_handle;
-  }
-  void RegisterRecvFinishHandle(uint32_t app_thread_id, uint32_t model_id,
-                                const std::function<void()>& recv_finish_handle) override {
-    EXPECT_EQ(app_thread_id, kTestAppThreadId);
-    EXPECT_EQ(model_id, kTestModelId);
-    recv_finish_handle_ = recv_finish_handle;
-  }
-
-  void NewRequest(uint32_t app_thread_id, uint32_t model_id, uint32_t expected_responses) override {
-    EXPECT_EQ(app_thread_id, kTestAppThreadId);
-    EXPECT_EQ(model_id, kTestModelId);
-    tracker_ = {expected_responses, 0};
-  }
-  void WaitRequest(uint32_t app_thread_id, uint32_t model_id) override {
-    EXPECT_EQ(app_thread_id, kTestAppThreadId);
-    EXPECT_EQ(model_id, kTestModelId);
-    std::unique_lock<std::mutex> lk(mu_);
-    cond_.wait(lk, [this] { return tracker_.first == tracker_.second; });
-  }
   void AddResponse(uint32_t app_thread_id, uint32_t model_id, Message& m) override {
     EXPECT_EQ(app_thread_id, kTestAppThreadId);
     EXPECT_EQ(model_id, kTestModelId);
@@ -82,27 +58,33 @@ class FakeCallbackRunner : public AbstractCallbackRunner {
     bool recv_finish = false;
     {
       std::lock_guard<std::mutex> lk(mu_);
-      recv_finish = tracker_.first == tracker_.second + 1 ? true : false;
+      recv_finish = ++tracker_.second == tracker_.first;
     }
     recv_handle_(m);
     if (recv_finish) {
       recv_finish_handle_();
     }
-    {
-      std::lock_guard<std::mutex> lk(mu_);
-      tracker_.second += 1;
-      if (recv_finish) {
-        cond_.notify_all();
-      }
-    }
   }
+  int NewAsyncRequest(uint32_t expected_responses, const std::function<void(Message&)>& recv_handle,
+                      const std::function<void()>& recv_finish_handle) override {
+    // one request at a time
+    tracker_ = {expected_responses, 0};
+    recv_handle_ = recv_handle;
+    recv_finish_handle_ = recv_finish_handle;
+    return 0;
+  }
+  void RegisterPushHandle(uint32_t app_thread_id, uint32_t model_id,
+                          const std::function<void(Message&)>& push_handle) override {
+    push_handle_ = push_handle;
+  }
+  void AddPush(uint32_t app_thread_id, uint32_t model_id, Message& m) override { push_handle_(m); }
 
  private:
+  std::function<void(Message&)> push_handle_;
   std::function<void(Message&)> recv_handle_;
   std::function<void()> recv_finish_handle_;
 
   std::mutex mu_;
-  std::condition_variable cond_;
   std::pair<uint32_t, uint32_t> tracker_;
 };
 
@@ -216,11 +198,15 @@ TEST_F(TestKVClientTable, Get) {
   third_party::SArray<Key> r1_keys{3};
   third_party::SArray<double> r1_vals{0.1};
   r1.meta.flag = Flag::kGet;
+  r1.meta.sender = 0;
+  r1.meta.request_id = m1.meta.request_id;
   r1.AddData(r1_keys);
   r1.AddData(r1_vals);
   third_party::SArray<Key> r2_keys{4, 5, 6};
   third_party::SArray<double> r2_vals{0.4, 0.2, 0.3};
   r2.meta.flag = Flag::kGet;
+  r2.meta.sender = 1;
+  r2.meta.request_id = m2.meta.request_id;
   r2.AddData(r2_keys);
   r2.AddData(r2_vals);
   callback_runner.AddResponse(kTestAppThreadId, kTestModelId, r1);
@@ -228,4 +214,478 @@ TEST_F(TestKVClientTable, Get) {
   th.join();
 }
 
+TEST_F(TestKVClientTable, AddRows) {
+  ThreadsafeQueue<Message> queue;
+  FakePartitionManager manager({0, 1}, 4);
+  CallbackRunner callback_runner;
+
+  KVClientTable<float> table(kTestAppThreadId, kTestModelId, &queue, &manager, &callback_runner);
+
+  std::vector<Key> keys = {3, 4, 5};
+  std::vector<float> rows = {0.3, 3.0, 0.4, 4.0, 0.5, 5.0};
+  table.AddRows(keys, rows);  // {3,4,5} -> {3}, {4,5}
+  Message m1, m2;
+  queue.WaitAndPop(&m1);
+  queue.WaitAndPop(&m2);
+
+  EXPECT_EQ(m1.meta.recver, 0);
+  EXPECT_EQ(m1.meta.flag, Flag::kAdd);
+  ASSERT_EQ(m1.data.size(), 2);
+  third_party::SArray<Key> res_keys(m1.data[0]);
+  third_party::SArray<float> res_rows(m1.data[1]);
+  ASSERT_EQ(res_keys.size(), 1);
+  EXPECT_EQ(res_keys[0], 3);
+  ASSERT_EQ(res_rows.size(), 2);
+  EXPECT_FLOAT_EQ(res_rows[0], 0.3);
+  EXPECT_FLOAT_EQ(res_rows[1], 3.0);
+
+  EXPECT_EQ(m2.meta.recver, 1);
+  ASSERT_EQ(m2.data.size(), 2);
+  res_keys = m2.data[0];
+  res_rows = m2.data[1];
+  ASSERT_EQ(res_keys.size(), 2);
+  ASSERT_EQ(res_rows.size(), 4);
+  std::vector<float> expected{0.4, 4.0, 0.5, 5.0};
+  EXPECT_EQ(std::vector<float>(res_rows.begin(), res_rows.end()), expected);
+}
+
+TEST_F(TestKVClientTable, GetRows) {
+  ThreadsafeQueue<Message> queue;
+  FakePartitionManager manager({0, 1}, 4);
+  CallbackRunner callback_runner;
+
+  std::thread th([&queue, &manager, &callback_runner]() {
+    KVClientTable<float> table(kTestAppThreadId, kTestModelId, &queue, &manager, &callback_runner);
+    std::vector<Key> keys = {3, 4, 5};
+    std::vector<float> rows;
+    table.GetRows(keys, &rows);  // {3,4,5} -> {3}, {4,5}
+    std::vector<float> expected{0.3, 3.0, 0.4, 4.0, 0.5, 5.0};
+    EXPECT_EQ(rows, expected);
+  });
+  Message m1, m2;
+  queue.WaitAndPop(&m1);
+  queue.WaitAndPop(&m2);
+  EXPECT_EQ(m1.meta.flag, Flag::kGet);
+  EXPECT_EQ(m2.meta.flag, Flag::kGet);
+  EXPECT_GE(m1.meta.request_id, 0);
+  EXPECT_EQ(m1.meta.request_id, m2.meta.request_id);
+
+  // reply out of order, the rows should still follow the order of keys
+  Message r1, r2;
+  r1.meta.request_id = r2.meta.request_id = m1.meta.request_id;
+  r2.meta.sender = 1;
+  r2.meta.flag = Flag::kGet;
+  r2.AddData(third_party::SArray<Key>{4, 5});
+  r2.AddData(third_party::SArray<float>{0.4, 4.0, 0.5, 5.0});
+  r1.meta.sender = 0;
+  r1.meta.flag = Flag::kGet;
+  r1.AddData(third_party::SArray<Key>{3});
+  r1.AddData(third_party::SArray<float>{0.3, 3.0});
+  callback_runner.AddResponse(kTestAppThreadId, kTestModelId, r2);
+  callback_runner.AddResponse(kTestAppThreadId, kTestModelId, r1);
+  th.join();
+}
+
+TEST_F(TestKVClientTable, Encoding) {
+  ThreadsafeQueue<Message> queue;
+  FakePartitionManager manager({0, 1}, 4);
+  CallbackRunner callback_runner;
+
+  std::thread th([&queue, &manager, &callback_runner]() {
+    KVClientTable<double> table(kTestAppThreadId, kTestModelId, &queue, &manager, &callback_runner,
+                                ValueEncoding::Float16);
+    table.Add(std::vector<Key>{3, 4}, std::vector<double>{0.5, -2.0});
+    std::vector<double> vals;
+    table.Get(std::vector<Key>{3, 4}, &vals);
+    std::vector<double> expected{0.25, 1.5};
+    EXPECT_EQ(vals, expected);
+  });
+  Message m1, m2;
+  queue.WaitAndPop(&m1);
+  queue.WaitAndPop(&m2);
+  ASSERT_EQ(m1.data.size(), 2);
+  ASSERT_EQ(m1.data[1].size(), sizeof(Half));  // one value in half precision
+  EXPECT_FLOAT_EQ(third_party::SArray<Half>(m1.data[1])[0], 0.5f);
+  EXPECT_FLOAT_EQ(third_party::SArray<Half>(m2.data[1])[0], -2.0f);
+
+  Message g1, g2;
+  queue.WaitAndPop(&g1);
+  queue.WaitAndPop(&g2);
+  Message r1, r2;
+  r1.meta.flag = r2.meta.flag = Flag::kGet;
+  r1.meta.request_id = r2.meta.request_id = g1.meta.request_id;
+  r1.meta.sender = 0;
+  r2.meta.sender = 1;
+  r1.AddData(third_party::SArray<Key>{3});
+  r1.AddData(third_party::SArray<Half>{Half(0.25f)});
+  r2.AddData(third_party::SArray<Key>{4});
+  r2.AddData(third_party::SArray<Half>{Half(1.5f)});
+  callback_runner.AddResponse(kTestAppThreadId, kTestModelId, r1);
+  callback_runner.AddResponse(kTestAppThreadId, kTestModelId, r2);
+  th.join();
+}
+
+TEST_F(TestKVClientTable, AggregatedClock) {
+  ThreadsafeQueue<Message> queue;
+  FakePartitionManager manager({0, 1}, 4);
+  CallbackRunner callback_runner;
+  ClockAggregator aggregator(50, &queue);
+  aggregator.InitTable(kTestModelId, &manager, {kTestAppThreadId, kTestAppThreadId + 1});
+
+  KVClientTable<double> table(kTestAppThreadId, kTestModelId, &queue, &manager, &callback_runner,
+                              ValueEncoding::Native, &aggregator);
+  KVClientTable<double> table2(kTestAppThreadId + 1, kTestModelId, &queue, &manager, &callback_runner,
+                               ValueEncoding::Native, &aggregator);
+  table.Clock();
+  table.Clock();
+  EXPECT_EQ(queue.Size(), 0);  // the other local worker has not clocked
+  table2.Clock();
+  ASSERT_EQ(queue.Size(), 2);  // one group clock per server
+  Message m;
+  for (uint32_t sid : {0, 1}) {
+    queue.WaitAndPop(&m);
+    EXPECT_EQ(m.meta.flag, Flag::kClock);
+    EXPECT_EQ(m.meta.sender, 50);
+    EXPECT_EQ(m.meta.recver, sid);
+  }
+
+  // the servers learn the clock of a worker from its requests, one per server
+  table.Add(std::vector<Key>{1}, std::vector<double>{0.5});
+  table2.Add(std::vector<Key>{1}, std::vector<double>{0.5});
+  for (int clock : {2, 2, 1, 1}) {
+    queue.WaitAndPop(&m);
+    EXPECT_EQ(m.meta.flag, Flag::kAdd);
+    EXPECT_EQ(m.meta.clock, clock);
+  }
+}
+
+TEST_F(TestKVClientTable, Subscribe) {
+  ThreadsafeQueue<Message> queue;
+  FakePartitionManager manager({0, 1}, 4);
+  CallbackRunner callback_runner;
+  KVClientTable<double> table(kTestAppThreadId, kTestModelId, &queue, &manager, &callback_runner);
+  table.Subscribe(std::vector<Key>{3, 4, 5});
+  Message m;
+  for (uint32_t sid : {0, 1}) {
+    queue.WaitAndPop(&m);
+    EXPECT_EQ(m.meta.flag, Flag::kSubscribe);
+    EXPECT_EQ(m.meta.recver, sid);
+  }
+
+  // a Get before the servers pushed asks them
+  std::thread th([&table] {
+    std::vector<double> vals;
+    table.Get(std::vector<Key>{3}, &vals);
+  });
+  for (int i = 0; i < 2; ++i) {
+    queue.WaitAndPop(&m);
+    EXPECT_EQ(m.meta.flag, Flag::kGet);
+    Message reply;
+    reply.meta.flag = Flag::kGet;
+    reply.meta.sender = m.meta.recver;
+    reply.meta.request_id = m.meta.request_id;
+    reply.AddData(third_party::SArray<Key>(m.data[0]));
+    reply.AddData(third_party::SArray<double>(third_party::SArray<Key>(m.data[0]).size(), 0.1));
+    callback_runner.AddResponse(kTestAppThreadId, kTestModelId, reply);
+  }
+  th.join();
+
+  Message p1, p2;
+  p1.meta.flag = Flag::kPush;
+  p1.meta.sender = 0;
+  p1.meta.clock = 0;
+  p1.AddData(third_party::SArray<Key>{3});
+  p1.AddData(third_party::SArray<double>{0.3});
+  p2.meta.flag = Flag::kPush;
+  p2.meta.sender = 1;
+  p2.meta.clock = 0;
+  p2.AddData(third_party::SArray<Key>{4, 5});
+  p2.AddData(third_party::SArray<double>{0.4, 0.5});
+  callback_runner.AddPush(kTestAppThreadId, kTestModelId, p1);
+  callback_runner.AddPush(kTestAppThreadId, kTestModelId, p2);
+
+  // served from the pushed values, in the order of keys
+  std::vector<double> vals;
+  table.Get(std::vector<Key>{5, 3}, &vals);
+  EXPECT_EQ(vals, std::vector<double>({0.5, 0.3}));
+  EXPECT_EQ(queue.Size(), 0);
+
+  // at clock 1 the Get waits for both servers to push the values readable at clock 1
+  table.Clock();
+  for (int i = 0; i < 2; ++i) queue.WaitAndPop(&m);
+  std::thread th2([&table] {
+    std::vector<double> vals;
+    table.Get(std::vector<Key>{4, 3}, &vals);
+    EXPECT_EQ(vals, std::vector<double>({0.8, 0.3}));
+  });
+  p1.data.clear();
+  p1.AddData(third_party::SArray<Key>());
+  p1.AddData(third_party::SArray<double>());
+  p1.meta.clock = 1;
+  callback_runner.AddPush(kTestAppThreadId, kTestModelId, p1);
+  p2.data.clear();
+  p2.AddData(third_party::SArray<Key>{4});
+  p2.AddData(third_party::SArray<double>{0.8});
+  p2.meta.clock = 1;
+  callback_runner.AddPush(kTestAppThreadId, kTestModelId, p2);
+  th2.join();
+  EXPECT_EQ(queue.Size(), 0);
+}
+
+TEST_F(TestKVClientTable, ClientCache) {
+  ThreadsafeQueue<Message> queue;
+  FakePartitionManager manager({0, 1}, 4);
+  CallbackRunner callback_runner;
+  ClientCache cache;
+  KVClientTable<double> table(kTestAppThreadId, kTestModelId, &queue, &manager, &callback_runner,
+                              ValueEncoding::Native, nullptr, &cache);
+  // reply to the Gets of the servers, whose values may be read until clock 1
+  auto serve = [&queue, &callback_runner](int num_requests, std::vector<Key>* requested) {
+    Message m;
+    for (int i = 0; i < num_requests; ++i) {
+      queue.WaitAndPop(&m);
+      EXPECT_EQ(m.meta.flag, Flag::kGet);
+      third_party::SArray<Key> keys(m.data[0]);
+      requested->insert(requested->end(), keys.begin(), keys.end());
+      Message reply;
+      reply.meta.flag = Flag::kGet;
+      reply.meta.sender = m.meta.recver;
+      reply.meta.request_id = m.meta.request_id;
+      reply.meta.clock = 1;
+      reply.AddData(keys);
+      third_party::SArray<double> vals(keys.size());
+      for (size_t j = 0; j < keys.size(); ++j) vals[j] = keys[j] / 10.0;
+      reply.AddData(vals);
+      callback_runner.AddResponse(kTestAppThreadId, kTestModelId, reply);
+    }
+  };
+
+  Message clock_msg;
+  std::vector<Key> requested;
+  std::thread th([&table] {
+    std::vector<double> vals;
+    table.Get(std::vector<Key>{3, 5}, &vals);
+    EXPECT_EQ(vals, std::vector<double>({0.3, 0.5}));
+  });
+  serve(2, &requested);
+  th.join();
+  EXPECT_EQ(requested, std::vector<Key>({3, 5}));
+
+  // cached keys are read locally, only key 6 is fetched
+  requested.clear();
+  table.Clock();
+  for (int i = 0; i < 2; ++i) queue.WaitAndPop(&clock_msg);
+  std::thread th2([&table] {
+    std::vector<double> vals;
+    table.Get(std::vector<Key>{3, 6, 5}, &vals);
+    EXPECT_EQ(vals, std::vector<double>({0.3, 0.6, 0.5}));
+  });
+  serve(2, &requested);
+  th2.join();
+  EXPECT_EQ(requested, std::vector<Key>({6}));
+  EXPECT_EQ(cache.GetNumHits(), 2);
+
+  // an Add of the thread erases the key, which is fetched again with the Add applied
+  requested.clear();
+  table.Add(std::vector<Key>{5}, std::vector<double>{1.0});
+  for (int i = 0; i < 2; ++i) queue.WaitAndPop(&clock_msg);
+  std::thread th_add([&table] {
+    std::vector<double> vals;
+    table.Get(std::vector<Key>{3, 5}, &vals);
+  });
+  serve(2, &requested);
+  th_add.join();
+  EXPECT_EQ(requested, std::vector<Key>({5}));
+
+  // a reply to a Get sent before the erase is not cached
+  auto epoch = cache.GetEpoch();
+  cache.Erase(third_party::SArray<Key>{7});
+  cache.Insert(third_party::SArray<Key>{7}, third_party::SArray<char>(sizeof(double)), 1, epoch);
+  third_party::SArray<char> cached;
+  std::vector<size_t> misses;
+  cache.Get(third_party::SArray<Key>{7}, 1, &cached, &misses);
+  EXPECT_EQ(misses, std::vector<size_t>({0}));
+
+  // at clock 2 the cached values have expired
+  requested.clear();
+  table.Clock();
+  for (int i = 0; i < 2; ++i) queue.WaitAndPop(&clock_msg);
+  std::thread th3([&table] {
+    std::vector<double> vals;
+    table.Get(std::vector<Key>{3}, &vals);
+  });
+  serve(2, &requested);
+  th3.join();
+  EXPECT_EQ(requested, std::vector<Key>({3}));
+}
+
+TEST_F(TestKVClientTable, GetAsync) {
+  ThreadsafeQueue<Message> queue;
+  FakePartitionManager manager({0, 1}, 4);
+  CallbackRunner callback_runner;
+  KVClientTable<double> table(kTestAppThreadId, kTestModelId, &queue, &manager, &callback_runner);
+
+  // two requests in flight on the same table
+  auto first = table.GetAsync(third_party::SArray<Key>{3, 5});
+  auto second = table.GetAsync(third_party::SArray<Key>{6});
+  std::vector<Message> requests(4);
+  for (auto& m : requests) queue.WaitAndPop(&m);
+  EXPECT_EQ(requests[0].meta.request_id, requests[1].meta.request_id);
+  EXPECT_EQ(requests[2].meta.request_id, requests[3].meta.request_id);
+  EXPECT_NE(requests[0].meta.request_id, requests[2].meta.request_id);
+
+  // the second request completes first
+  for (int i : {3, 2, 1, 0}) {
+    third_party::SArray<Key> keys(requests[i].data[0]);
+    Message reply;
+    reply.meta.flag = Flag::kGet;
+    reply.meta.sender = requests[i].meta.recver;
+    reply.meta.request_id = requests[i].meta.request_id;
+    reply.AddData(keys);
+    third_party::SArray<double> vals(keys.size());
+    for (size_t j = 0; j < keys.size(); ++j) vals[j] = keys[j] / 10.0;
+    reply.AddData(vals);
+    callback_runner.AddResponse(kTestAppThreadId, kTestModelId, reply);
+    if (i == 2) {
+      auto vals = second.get();
+      EXPECT_EQ(std::vector<double>(vals.begin(), vals.end()), std::vector<double>({0.6}));
+    }
+  }
+  auto vals = first.get();
+  EXPECT_EQ(std::vector<double>(vals.begin(), vals.end()), std::vector<double>({0.3, 0.5}));
+}
+
+TEST_F(TestKVClientTable, GetInto) {
+  ThreadsafeQueue<Message> queue;
+  FakePartitionManager manager({0, 1}, 4);
+  CallbackRunner callback_runner;
+
+  std::vector<float> rows(6);
+  std::thread th([&queue, &manager, &callback_runner, &rows]() {
+    KVClientTable<float> table(kTestAppThreadId, kTestModelId, &queue, &manager, &callback_runner,
+                               ValueEncoding::Float16);
+    table.GetInto(third_party::SArray<Key>{3, 4, 5}, rows.data(), rows.size());  // {3,4,5} -> {3}, {4,5}
+  });
+  Message m1, m2;
+  queue.WaitAndPop(&m1);
+  queue.WaitAndPop(&m2);
+
+  // the replies are decoded into the rows of their keys, whatever their order
+  Message r1, r2;
+  r1.meta.flag = r2.meta.flag = Flag::kGet;
+  r1.meta.request_id = r2.meta.request_id = m1.meta.request_id;
+  r1.meta.sender = 0;
+  r2.meta.sender = 1;
+  r1.AddData(third_party::SArray<Key>{3});
+  r1.AddData(third_party::SArray<Half>{Half(0.5f), Half(3.0f)});
+  r2.AddData(third_party::SArray<Key>{4, 5});
+  r2.AddData(third_party::SArray<Half>{Half(0.25f), Half(4.0f), Half(-1.0f), Half(5.0f)});
+  callback_runner.AddResponse(kTestAppThreadId, kTestModelId, r2);
+  callback_runner.AddResponse(kTestAppThreadId, kTestModelId, r1);
+  th.join();
+  EXPECT_EQ(rows, std::vector<float>({0.5, 3.0, 0.25, 4.0, -1.0, 5.0}));
+}
+
+TEST_F(TestKVClientTable, AddBuffer) {
+  ThreadsafeQueue<Message> queue;
+  FakePartitionManager manager({0, 1}, 4);
+  FakeCallbackRunner callback_runner;
+  KVClientTable<double> table(kTestAppThreadId, kTestModelId, &queue, &manager, &callback_runner);
+  table.EnableAddBuffer(UpdateMode::Accumulate, 1 << 20);
+
+  table.Add(std::vector<Key>{5, 3}, std::vector<double>{1.0, 2.0});
+  table.Add(std::vector<Key>{3, 6}, std::vector<double>{0.5, 4.0});
+  EXPECT_EQ(queue.Size(), 0);  // nothing is sent before the Clock
+
+  table.Clock();  // {3,5,6} -> {3}, {5,6}, then one clock per server
+  ASSERT_EQ(queue.Size(), 4);
+  Message m1, m2;
+  queue.WaitAndPop(&m1);
+  queue.WaitAndPop(&m2);
+  EXPECT_EQ(m1.meta.flag, Flag::kAdd);
+  EXPECT_EQ(m1.meta.recver, 0);
+  third_party::SArray<Key> res_keys(m1.data[0]);
+  third_party::SArray<double> res_vals(m1.data[1]);
+  ASSERT_EQ(res_keys.size(), 1);
+  EXPECT_EQ(res_keys[0], 3);
+  EXPECT_DOUBLE_EQ(res_vals[0], 2.5);
+  EXPECT_EQ(m2.meta.flag, Flag::kAdd);
+  EXPECT_EQ(m2.meta.recver, 1);
+  res_keys = m2.data[0];
+  res_vals = m2.data[1];
+  ASSERT_EQ(res_keys.size(), 2);
+  EXPECT_EQ(res_keys[0], 5);
+  EXPECT_EQ(res_keys[1], 6);
+  EXPECT_DOUBLE_EQ(res_vals[0], 1.0);
+  EXPECT_DOUBLE_EQ(res_vals[1], 4.0);
+  for (int i = 0; i < 2; ++i) {
+    Message clock;
+    queue.WaitAndPop(&clock);
+    EXPECT_EQ(clock.meta.flag, Flag::kClock);
+  }
+
+  // Assign keeps the last row, and a full buffer is sent without waiting for the Clock
+  size_t row_bytes = sizeof(Key) + sizeof(double);
+  table.EnableAddBuffer(UpdateMode::Assign, 2 * row_bytes);
+  table.Add(std::vector<Key>{5}, std::vector<double>{1.0});
+  table.Add(std::vector<Key>{5}, std::vector<double>{3.0});
+  EXPECT_EQ(queue.Size(), 0);
+  table.Add(std::vector<Key>{6}, std::vector<double>{2.0});  // {5,6} -> {}, {5,6}
+  ASSERT_EQ(queue.Size(), 2);
+  queue.WaitAndPop(&m1);
+  queue.WaitAndPop(&m2);
+  res_keys = m2.data[0];
+  res_vals = m2.data[1];
+  ASSERT_EQ(res_keys.size(), 2);
+  EXPECT_DOUBLE_EQ(res_vals[0], 3.0);
+  EXPECT_DOUBLE_EQ(res_vals[1], 2.0);
+}
+
+TEST_F(TestKVClientTable, NormalizeKeys) {
+  ThreadsafeQueue<Message> queue;
+  FakePartitionManager manager({0, 1}, 4);
+  CallbackRunner callback_runner;
+
+  std::vector<double> vals;
+  std::thread th([&queue, &manager, &callback_runner, &vals]() {
+    KVClientTable<double> table(kTestAppThreadId, kTestModelId, &queue, &manager, &callback_runner);
+    table.EnableKeyNormalization(UpdateMode::Accumulate);
+    table.Add(std::vector<Key>{6, 3, 6, 5}, std::vector<double>{1.0, 2.0, 0.5, 4.0});
+    table.Get(std::vector<Key>{6, 3, 6, 5, 3}, &vals);
+  });
+
+  // the rows of key 6 are summed, and the keys are sent sorted: {3,5,6} -> {3}, {5,6}
+  Message m1, m2;
+  queue.WaitAndPop(&m1);
+  queue.WaitAndPop(&m2);
+  EXPECT_EQ(m1.meta.flag, Flag::kAdd);
+  third_party::SArray<Key> res_keys(m2.data[0]);
+  third_party::SArray<double> res_vals(m2.data[1]);
+  ASSERT_EQ(res_keys.size(), 2);
+  EXPECT_EQ(res_keys[0], 5);
+  EXPECT_EQ(res_keys[1], 6);
+  EXPECT_DOUBLE_EQ(res_vals[0], 4.0);
+  EXPECT_DOUBLE_EQ(res_vals[1], 1.5);
+
+  // each key is asked once, and the values come back in the order of the keys of the Get
+  queue.WaitAndPop(&m1);
+  queue.WaitAndPop(&m2);
+  for (auto* m : {&m1, &m2}) {
+    EXPECT_EQ(m->meta.flag, Flag::kGet);
+    third_party::SArray<Key> keys(m->data[0]);
+    Message reply;
+    reply.meta.flag = Flag::kGet;
+    reply.meta.sender = m->meta.recver;
+    reply.meta.request_id = m->meta.request_id;
+    reply.AddData(keys);
+    third_party::SArray<double> rows(keys.size());
+    for (size_t j = 0; j < keys.size(); ++j) rows[j] = keys[j] / 10.0;
+    reply.AddData(rows);
+    if (m->meta.recver == 1) EXPECT_EQ(keys.size(), 2);
+    callback_runner.AddResponse(kTestAppThreadId, kTestModelId, reply);
+  }
+  th.join();
+  EXPECT_EQ(vals, std::vector<double>({0.6, 0.3, 0.6, 0.5, 0.3}));
+}
+
 }  // namespace csci5570
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "base/magic.hpp"
+#include "base/message.hpp"
+#include "base/third_party/sarray.h"
+#include "base/value_encoding.hpp"
+
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace csci5570 {
+
+/**
+ * The values that the servers push to a worker for the keys it subscribed to
+ *
+ * Filled by the worker helper thread and read by the user thread. Every push of a server carries the last clock
+ * of the worker at which the values of that server may be read, so a Get of subscribed keys only waits for the
+ * push of the min clock advance it depends on, instead of sending requests to the servers.
+ */
+template <typename Val>
+class PushCache {
+ public:
+  /**
+   * @param num_servers   the number of server threads the subscription was sent to
+   */
+  explicit PushCache(size_t num_servers) : num_servers_(num_servers) {}
+
+  void OnPush(ValueEncoding encoding, Message& msg) {
+    third_party::SArray<Key> keys(msg.data[0]);
+    auto vals = DecodeValues<Val>(encoding, msg.data[1]);
+    std::lock_guard<std::mutex> lk(mu_);
+    if (!keys.empty()) {
+      if (row_width_ == 0) row_width_ = vals.size() / keys.size();
+      CHECK_EQ(keys.size() * row_width_, vals.size());
+      for (size_t i = 0; i < keys.size(); ++i) {
+        auto it = index_.find(keys[i]);
+        if (it == index_.end()) {
+          it = index_.emplace(keys[i], rows_.size() / row_width_).first;
+          rows_.resize(rows_.size() + row_width_);
+        }
+        memcpy(rows_.data() + it->second * row_width_, vals.data() + i * row_width_, row_width_ * sizeof(Val));
+      }
+    }
+    readable_through_[msg.meta.sender] = msg.meta.clock;
+    cond_.notify_all();
+  }
+
+  /**
+   * Read the rows of keys in their order, waiting until every server has pushed the values readable at <clock>
+   *
+   * @return  false without waiting if some key has not been pushed, so the caller has to ask the servers
+   */
+  bool Get(const third_party::SArray<Key>& keys, int clock, third_party::SArray<Val>* rows) {
+    std::unique_lock<std::mutex> lk(mu_);
+    if (readable_through_.size() < num_servers_) return false;
+    for (auto key : keys) {
+      if (index_.find(key) == index_.end()) return false;
+    }
+    cond_.wait(lk, [this, clock] {
+      for (auto& server : readable_through_) {
+        if (server.second < clock) return false;
+      }
+      return true;
+    });
+    rows->resize(keys.size() * row_width_);
+    for (size_t i = 0; i < keys.size(); ++i) {
+      memcpy(rows->data() + i * row_width_, rows_.data() + index_[keys[i]] * row_width_, row_width_ * sizeof(Val));
+    }
+    return true;
+  }
+
+ private:
+  size_t num_servers_;
+  size_t row_width_ = 0;                   // known from the first non-empty push
+  std::unordered_map<Key, size_t> index_;  // key -> row
+  std::vector<Val> rows_;
+  std::map<int, int> readable_through_;    // server thread id -> the last clock its values may be read at
+
+  std::mutex mu_;
+  std::condition_variable cond_;
+};
+
+}  // namespace csci5570
@@ -4,6 +4,7 @@
 #include "base/message.hpp"
 #include "base/threadsafe_queue.hpp"
 
+#include <atomic>
 #include <condition_variable>
 #include <memory>
 #include <thread>
@@ -40,6 +41,9 @@ class WorkerHelperThread: public AbstractWorkerThread {
           case Flag::kGet:
             OnReceive(msg);
             break;
+          case Flag::kPush:
+            callback_runner_->AddPush(msg.meta.recver, msg.meta.model_id, msg);
+            break;
           case Flag::kResetWorkerInModel:
             reset_msg_cnt++;
             break;
@@ -57,7 +61,7 @@ class WorkerHelperThread: public AbstractWorkerThread {
     }
   private:
     AbstractCallbackRunner* callback_runner_;
-    int reset_msg_cnt;
+    std::atomic<int> reset_msg_cnt;  // polled by the engine thread
 };
 
 }  // namespace csci5570